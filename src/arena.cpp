@@ -0,0 +1,82 @@
+
+#include "main.h"
+
+Arena turn_arena;
+
+Arena::~Arena() {
+    for (auto& b : blocks) {
+        free(b.data);
+    }
+}
+
+/*
+Oversized requests get a dedicated block of their own. Blocks that are too
+small for the current request are skipped until the next reset.
+*/
+void* Arena::alloc(size_t size, size_t align) {
+    while (block_id < blocks.size()) {
+        Block& b = blocks[block_id];
+        size_t start = (offset + align - 1) & ~(align - 1);
+        if (start + size <= b.size) {
+            offset = start + size;
+            used += size;
+            count++;
+            return b.data + start;
+        }
+        block_id++;
+        offset = 0;
+    }
+    size_t len = max(size, ArenaBlockSize);
+    char* data = (char*)malloc(len);
+    if (!data) {
+        throw std::bad_alloc();
+    }
+    blocks.push_back({data, len});
+    block_id = blocks.size() - 1;
+    offset = size;
+    used += size;
+    count++;
+    return data;
+}
+
+void Arena::reset() {
+    turn_peak = max(turn_peak, used);
+    turn_total += used;
+    turn_count += count;
+    turn_resets++;
+    block_id = 0;
+    offset = 0;
+    used = 0;
+    count = 0;
+}
+
+size_t Arena::reserved() const {
+    size_t total = 0;
+    for (auto& b : blocks) {
+        total += b.size;
+    }
+    return total;
+}
+
+/*
+Release all memory allocated for the previous faction turn.
+*/
+void arena_reset() {
+    turn_arena.reset();
+}
+
+/*
+Summarize the allocations since the last report and start new statistics.
+Peak is the largest amount of memory used by a single faction turn.
+*/
+void arena_report() {
+    Arena& a = turn_arena;
+    debug("arena_report %d peak: %u total: %u allocs: %u resets: %u reserved: %u\n",
+        *CurrentTurn, (uint32_t)max(a.turn_peak, a.allocated()),
+        (uint32_t)(a.turn_total + a.allocated()), (uint32_t)(a.turn_count + a.allocations()),
+        (uint32_t)a.turn_resets, (uint32_t)a.reserved());
+    a.turn_peak = 0;
+    a.turn_total = 0;
+    a.turn_count = 0;
+    a.turn_resets = 0;
+}
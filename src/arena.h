@@ -0,0 +1,80 @@
+#pragma once
+
+const size_t ArenaBlockSize = 1 << 20;
+
+/*
+Bump pointer allocator for data that lives only for the duration of a single
+faction turn. Individual deallocations are ignored and all memory is reclaimed
+at once by reset, which keeps the blocks reserved for the next faction turn.
+*/
+class Arena {
+    private:
+    struct Block {
+        char* data;
+        size_t size;
+    };
+    std::vector<Block> blocks;
+    size_t block_id = 0;
+    size_t offset = 0;
+    size_t used = 0;
+    size_t count = 0;
+    public:
+    size_t turn_peak = 0;
+    size_t turn_total = 0;
+    size_t turn_count = 0;
+    size_t turn_resets = 0;
+
+    Arena() {}
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+    ~Arena();
+    void* alloc(size_t size, size_t align);
+    void reset();
+    size_t reserved() const;
+    size_t allocated() const { return used; }
+    size_t allocations() const { return count; }
+};
+
+extern Arena turn_arena;
+
+void arena_reset();
+void arena_report();
+
+template <class T>
+struct ArenaAllocator {
+    typedef T value_type;
+
+    ArenaAllocator() {}
+    template <class U>
+    ArenaAllocator(const ArenaAllocator<U>&) {}
+
+    T* allocate(size_t n) {
+        return (T*)turn_arena.alloc(n * sizeof(T), alignof(T));
+    }
+    void deallocate(T*, size_t) {}
+};
+
+template <class T, class U>
+bool operator==(const ArenaAllocator<T>&, const ArenaAllocator<U>&) {
+    return true;
+}
+
+template <class T, class U>
+bool operator!=(const ArenaAllocator<T>&, const ArenaAllocator<U>&) {
+    return false;
+}
+
+/*
+Containers using these aliases must be destroyed or reassigned before arena_reset.
+Calling clear is not enough since it may keep the bucket or node storage allocated.
+*/
+template <class T>
+using arena_vector = std::vector<T, ArenaAllocator<T>>;
+template <class T>
+using arena_list = std::list<T, ArenaAllocator<T>>;
+template <class T, class C = std::less<T>>
+using arena_set = std::set<T, C, ArenaAllocator<T>>;
+template <class K, class V, class H = std::hash<K>>
+using arena_map = std::unordered_map<K, V, H, std::equal_to<K>,
+    ArenaAllocator<std::pair<const K, V>>>;
+
@@ -231,6 +231,7 @@ int __cdecl mod_base_init(int faction_id, int x, int y) {
     if (is_human(faction_id)) {
         game_log("Base founded: %s at (%d, %d)", base->name, x, y);
     }
+    move_upkeep_event(UE_BaseChange, x, y);
     return base_id;
 }
 
@@ -238,6 +239,7 @@ void __cdecl mod_base_kill(int base_id) {
     assert(base_id >= 0 && base_id < *BaseCount);
     BASE* base = &Bases[base_id];
     int prev_faction = base->faction_id;
+    move_upkeep_event(UE_BaseChange, base->x, base->y);
     if (is_human(prev_faction)) {
         game_log("Base destroyed: %s at (%d, %d)", base->name, base->x, base->y);
     }
@@ -597,7 +599,8 @@ int __cdecl mod_base_making(int item_id, int base_id) {
     } else if (retool == RETOOL_NEVER_FREE) { // Never Free
         value = item_id;
     }
-    assert(value == base_making(item_id, base_id));
+    shadow_check(SC_BaseMaking, value, base_making(item_id, base_id),
+        "item: %d base: %d", item_id, base_id);
     return value;
 }
 
@@ -1992,6 +1995,7 @@ int __cdecl mod_base_upkeep(int base_id) {
     int faction_id = base->faction_id;
 
     set_base(base_id);
+    combat_cache_reset();
     *BaseUpkeepFlag = 0;
     base->state_flags &= ~(BSTATE_PSI_GATE_USED|BSTATE_FACILITY_SCRAPPED);
     base_compute(1); // Always update
@@ -2150,6 +2154,7 @@ int __cdecl mod_capture_base(int base_id, int faction_id, int is_probe) {
     if (base_id < 0 || base_id >= *BaseCount || faction_id < 0 || faction_id >= MaxPlayerNum) {
         return 0;
     }
+    move_upkeep_event(UE_BaseChange, base->x, base->y);
     int old_faction = base->faction_id;
     int prev_owner = base->faction_id;
     int last_spoke = *CurrentTurn - Factions[faction_id].diplo_spoke[old_faction];
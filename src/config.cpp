@@ -527,6 +527,7 @@ int __cdecl read_tech() {
             }
         }
     }
+    tech_preq_init();
     return false;
 }
 
@@ -2,6 +2,7 @@
 #include "debug.h"
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <stdarg.h>
 
 typedef int(__cdecl *Fexcept_handler3)(EXCEPTION_RECORD*, PVOID, CONTEXT*);
 Fexcept_handler3 _except_handler3 = (Fexcept_handler3)0x646DF8;
@@ -178,6 +179,100 @@ void __cdecl log_say_hex2(const char* a1, const char* a2, int a3, int a4, int a5
 Additional custom non-engine debugging functions.
 */
 
+/*
+Shadow checks compare Thinker replacements against the original engine functions
+(or faster versions against their reference implementation) in develop builds.
+Each check is verified on every rate-th call only, so that the builds remain fast
+enough to play late games. Rates can be changed with shadow_check=name,rate
+in thinker.ini, where rate 0 disables the check and a plain number sets all rates.
+The first failure of each check is written to the log with its parameters,
+later failures are only counted and summarized by shadow_report.
+*/
+struct ShadowCheck {
+    const char* name;
+    int rate;
+    uint32_t count;
+    uint32_t samples;
+    uint32_t failures;
+};
+
+static ShadowCheck shadow_checks[ShadowCheckNum] = {
+    {"goody_at", 64},
+    {"bonus_at", 64},
+    {"zoc_any", 64},
+    {"zoc_sea", 64},
+    {"zoc_veh", 64},
+    {"zoc_move", 64},
+    {"hex_cost_engine", 64},
+    {"stack_check", 16},
+    {"speed_proto", 8},
+    {"proto_cost", 8},
+    {"veh_cost", 8},
+    {"upgrade_cost", 1},
+    {"offense_proto", 16},
+    {"armor_proto", 16},
+    {"battle_fight", 1},
+    {"battle_odds", 256},
+    {"base_making", 4},
+    {"tech_val", 4},
+    {"mind_control", 1},
+    {"success_rates", 1},
+    {"minerals_at", 8},
+    {"site_score", 16},
+    {"air_refuel", 64},
+    {"influence", 8},
+};
+
+void shadow_config(const char* value) {
+    const char* sep = strchr(value, ',');
+    if (!sep) {
+        for (auto& c : shadow_checks) {
+            c.rate = max(0, atoi(value));
+        }
+        return;
+    }
+    for (auto& c : shadow_checks) {
+        if (strlen(c.name) == (size_t)(sep - value) && !strncmp(c.name, value, sep - value)) {
+            c.rate = max(0, atoi(sep + 1));
+            return;
+        }
+    }
+}
+
+bool shadow_sample(ShadowCheckType type) {
+    ShadowCheck& c = shadow_checks[type];
+    if (c.rate > 0 && ++c.count % c.rate == 0) {
+        c.samples++;
+        return true;
+    }
+    return false;
+}
+
+bool shadow_verify(ShadowCheckType type, bool valid, const char* fmt, ...) {
+    ShadowCheck& c = shadow_checks[type];
+    if (!valid && !c.failures++ && DEBUG && debug_log) {
+        va_list args;
+        va_start(args, fmt);
+        fprintf(debug_log, "shadow_check %s failed turn: %d ", c.name, *CurrentTurn);
+        vfprintf(debug_log, fmt, args);
+        fprintf(debug_log, "\n");
+        fflush(debug_log);
+        va_end(args);
+    }
+    return valid;
+}
+
+void shadow_report() {
+    for (auto& c : shadow_checks) {
+        if (c.failures) {
+            debug("shadow_check %-16s rate: %3d samples: %6u failures: %u\n",
+                c.name, c.rate, c.samples, c.failures);
+        } else if (c.samples) {
+            debug_ver("shadow_check %-16s rate: %3d samples: %6u\n", c.name, c.rate, c.samples);
+        }
+    }
+}
+
 void print_map(int x, int y) {
     MAP* m = mapsq(x, y);
     debug("MAP %3d %3d owner: %2d bonus: %d reg: %3d cont: %3d clim: %02x val2: %02x val3: %02x "\
@@ -14,3 +14,47 @@ void print_veh(int id);
 void print_unit(int id);
 void print_base(int id);
 
+enum ShadowCheckType {
+    SC_GoodyAt,
+    SC_BonusAt,
+    SC_ZocAny,
+    SC_ZocSea,
+    SC_ZocVeh,
+    SC_ZocMove,
+    SC_HexCostEngine,
+    SC_StackCheck,
+    SC_SpeedProto,
+    SC_ProtoCost,
+    SC_VehCost,
+    SC_UpgradeCost,
+    SC_OffenseProto,
+    SC_ArmorProto,
+    SC_BattleFight,
+    SC_BattleOdds,
+    SC_BaseMaking,
+    SC_TechVal,
+    SC_MindControl,
+    SC_SuccessRates,
+    SC_MineralsAt,
+    SC_SiteScore,
+    SC_AirRefuel,
+    SC_Influence,
+    ShadowCheckNum,
+};
+
+/*
+Compare a value against the reference expression on sampled calls in develop builds.
+*/
+#define shadow_check(type, value, expected, fmt, ...) do { \
+    if (DEBUG && shadow_sample(type)) { \
+        int _value = (value); \
+        int _expected = (expected); \
+        shadow_verify(type, _value == _expected, "value: %d expected: %d " fmt, \
+            _value, _expected, ##__VA_ARGS__); \
+    } } while (0)
+
+void shadow_config(const char* value);
+bool shadow_sample(ShadowCheckType type);
+bool shadow_verify(ShadowCheckType type, bool valid, const char* fmt, ...);
+void shadow_report();
+
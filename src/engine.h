@@ -166,8 +166,8 @@ struct PInfo {
     }
 };
 
-typedef std::unordered_map<Point, PInfo> PMTable;
-typedef std::set<MapNode> NodeSet;
+typedef arena_map<Point, PInfo> PMTable;
+typedef arena_set<MapNode> NodeSet;
 typedef std::set<Point> Points;
 typedef std::vector<Point> PointList;
 typedef std::set<std::string> set_str_t;
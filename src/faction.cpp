@@ -1188,45 +1188,127 @@ int __cdecl society_avail(int soc_category, int soc_model, int faction_id) {
 }
 
 /*
-Improved social engineering AI choices feature.
+Social engineering effects are memoized per faction for all 4^4 category tuples.
+Cached values are dropped whenever any of the inputs for social_calc changes
+(base effects or the projects and facilities checked there) or reset_state is called.
+*/
+struct SocialCache {
+    uint32_t epoch = 0;
+    uint32_t flags = 0;
+    CSocialEffect base = {};
+    uint32_t valid[MaxSocialModelNum*MaxSocialModelNum*MaxSocialModelNum*MaxSocialModelNum/32] = {};
+    CSocialEffect effects[MaxSocialModelNum*MaxSocialModelNum*MaxSocialModelNum*MaxSocialModelNum];
+};
+
+static SocialCache social_cache[MaxPlayerNum];
+static uint32_t social_cache_epoch = 1;
+
+void social_cache_reset() {
+    social_cache_epoch++;
+}
+
+static int social_index(const CSocialCategory& soc) {
+    return soc.politics | (soc.economics << 2) | (soc.values << 4) | (soc.future << 6);
+}
+
+static void social_cache_sync(int faction_id) {
+    Faction* f = &Factions[faction_id];
+    SocialCache& c = social_cache[faction_id];
+    uint32_t flags = (has_project(FAC_ASCETIC_VIRTUES, faction_id) ? 1 : 0)
+        | (has_project(FAC_LIVING_REFINERY, faction_id) ? 2 : 0)
+        | (has_project(FAC_NETWORK_BACKBONE, faction_id) ? 4 : 0)
+        | (has_project(FAC_CLONING_VATS, faction_id) ? 8 : 0)
+        | (has_temple(faction_id) ? 16 : 0);
+    if (c.epoch != social_cache_epoch || c.flags != flags
+    || memcmp(&c.base, &f->SE_economy_base, sizeof(c.base))) {
+        c.epoch = social_cache_epoch;
+        c.flags = flags;
+        memcpy(&c.base, &f->SE_economy_base, sizeof(c.base));
+        memset(c.valid, 0, sizeof(c.valid));
+    }
+}
+
+static const CSocialEffect& social_calc_cached(const CSocialCategory& soc, int faction_id) {
+    SocialCache& c = social_cache[faction_id];
+    int idx = social_index(soc);
+    assert(c.epoch == social_cache_epoch);
+    if (!(c.valid[idx / 32] & (1u << (idx % 32)))) {
+        CSocialCategory tmp = soc;
+        social_calc(&tmp, &c.effects[idx], faction_id, 0, 0);
+        c.valid[idx / 32] |= (1u << (idx % 32));
+    }
+    return c.effects[idx];
+}
+
+/*
+Social model independent values used by social_score, calculated once per faction turn.
 */
-static int social_score(int faction_id, int sf, int sm, bool pop_boom) {
-    assert(sf >= 0 && sf < 4 && sm >= 0 && sm < 4);
+struct SocialParams {
+    int def_val;
+    int base_val;
+    int base_ratio;
+    int morale_mod;
+    int probe_mod;
+    int drone_score;
+    bool pop_boom;
+    bool creche;
+    bool nodrones;
+    bool skipdrones;
+    bool cloning_vats;
+    bool longevity;
+    bool hunter_seeker;
+    bool manifold;
+    bool aircraft;
+};
+
+static void social_params(int faction_id, bool pop_boom, SocialParams& sp) {
     Faction* f = &Factions[faction_id];
     MFaction* m = &MFactions[faction_id];
-    int def_val = plans[faction_id].defense_modifier;
-    int base_val = max(1, f->base_count);
-    int base_ratio = min(10, 10 * f->base_count / clamp(*MapAreaSqRoot / 2, 8, 40));
-    int morale_mod = (has_project(FAC_COMMAND_NEXUS, faction_id) ? 2 : 0)
+    bool sphere = has_tech(Facility[FAC_PUNISHMENT_SPHERE].preq_tech, faction_id);
+    sp.def_val = plans[faction_id].defense_modifier;
+    sp.base_val = max(1, f->base_count);
+    sp.base_ratio = min(10, 10 * f->base_count / clamp(*MapAreaSqRoot / 2, 8, 40));
+    sp.morale_mod = (has_project(FAC_COMMAND_NEXUS, faction_id) ? 2 : 0)
         + (has_project(FAC_CYBORG_FACTORY, faction_id) ? 2 : 0);
-    int probe_mod = (*CurrentTurn - m->thinker_last_mc_turn < 10 ? def_val + 1 : 0);
+    sp.probe_mod = (*CurrentTurn - m->thinker_last_mc_turn < 10 ? sp.def_val + 1 : 0);
+    sp.drone_score = 3 + (m->rule_drone > 0) - (m->rule_talent > 0) - (sphere ? 1 : 0);
+    sp.pop_boom = pop_boom;
+    sp.creche = has_tech(Facility[FAC_CHILDREN_CRECHE].preq_tech, faction_id)
+        || has_free_facility(FAC_CHILDREN_CRECHE, faction_id);
+    sp.nodrones = has_free_facility(FAC_PUNISHMENT_SPHERE, faction_id);
+    sp.skipdrones = has_project(FAC_TELEPATHIC_MATRIX, faction_id);
+    sp.cloning_vats = has_project(FAC_CLONING_VATS, faction_id);
+    sp.longevity = has_project(FAC_LONGEVITY_VACCINE, faction_id);
+    sp.hunter_seeker = has_project(FAC_HUNTER_SEEKER_ALGORITHM, faction_id);
+    sp.manifold = has_project(FAC_MANIFOLD_HARMONICS, faction_id);
+    sp.aircraft = has_aircraft(faction_id);
+}
+
+/*
+Improved social engineering AI choices feature.
+Evaluate the combined score for all social categories set to the models in soc.
+*/
+static int social_score(int faction_id, const CSocialCategory& soc, const SocialParams& sp) {
+    Faction* f = &Factions[faction_id];
+    MFaction* m = &MFactions[faction_id];
+    const int def_val = sp.def_val;
+    const bool pop_boom = sp.pop_boom;
     int sc = 0;
     CSocialEffect vals;
-    CSocialCategory soc;
-    memcpy(&soc, &f->SE_Politics, sizeof(soc));
 
-    if ((&soc.politics)[sf] == sm) {
-        // Evaluate the current active social model.
+    if (!memcmp(&soc, &f->SE_Politics, sizeof(soc))) {
+        // Evaluate the current active social models.
         memcpy(&vals, &f->SE_economy, sizeof(vals));
     } else {
         // Take the faction base social values and apply all modifiers.
-        (&soc.politics)[sf] = sm;
-        memcpy(&vals, &f->SE_economy_base, sizeof(vals));
-        social_calc(&soc, &vals, faction_id, 0, 0);
+        memcpy(&vals, &social_calc_cached(soc, faction_id), sizeof(vals));
     }
     if (m->soc_priority_category >= 0 && m->soc_priority_model >= 0) {
-        if (sf == m->soc_priority_category) {
-            if (sm == m->soc_priority_model) {
-                sc += conf.social_ai_bias;
-            } else if (sm != SOCIAL_M_FRONTIER) {
-                sc -= conf.social_ai_bias;
-            }
-        } else {
-            if ((&f->SE_Politics)[m->soc_priority_category] == m->soc_priority_model) {
-                sc += conf.social_ai_bias;
-            } else if ((&f->SE_Politics)[m->soc_priority_category] != SOCIAL_M_FRONTIER) {
-                sc -= conf.social_ai_bias;
-            }
+        int model = (&soc.politics)[m->soc_priority_category];
+        if (model == m->soc_priority_model) {
+            sc += conf.social_ai_bias;
+        } else if (model != SOCIAL_M_FRONTIER) {
+            sc -= conf.social_ai_bias;
         }
     }
     // AIs also take into account Social Effect priorities whenever social_ai_bias >= 10
@@ -1243,51 +1325,44 @@ static int social_score(int faction_id, int sf, int sm, bool pop_boom) {
     if (vals.support < -3) {
         sc -= 16;
     }
-    if (vals.morale >= 1 && vals.morale + morale_mod >= 4) {
+    if (vals.morale >= 1 && vals.morale + sp.morale_mod >= 4) {
         sc += 10;
     }
-    if (vals.probe >= 3 && !has_project(FAC_HUNTER_SEEKER_ALGORITHM, faction_id)) {
+    if (vals.probe >= 3 && !sp.hunter_seeker) {
         sc += 4 * def_val;
     }
     sc += max(2, 2 + 4*f->AI_wealth + 3*f->AI_tech - f->AI_fight)
         * clamp(vals.economy, -3, 5);
-    sc += max(2, 2*f->AI_wealth + 2*f->AI_tech - f->AI_fight + base_ratio/2)
+    sc += max(2, 2*f->AI_wealth + 2*f->AI_tech - f->AI_fight + sp.base_ratio/2)
         * clamp(vals.efficiency, -4, 6);
-    sc += max(2, 3 + 2*f->AI_power + 2*f->AI_fight - base_ratio/4 + def_val/2)
+    sc += max(2, 3 + 2*f->AI_power + 2*f->AI_fight - sp.base_ratio/4 + def_val/2)
         * clamp(vals.support, -4, 3);
     sc += max(2, def_val + 2*f->AI_power + 2*f->AI_fight)
         * clamp(vals.morale, -4, 4);
-    bool creche = has_tech(Facility[FAC_CHILDREN_CRECHE].preq_tech, faction_id)
-        || has_free_facility(FAC_CHILDREN_CRECHE, faction_id);
-    bool sphere = has_tech(Facility[FAC_PUNISHMENT_SPHERE].preq_tech, faction_id);
-    bool nodrones = has_free_facility(FAC_PUNISHMENT_SPHERE, faction_id);
-    bool skipdrones = has_project(FAC_TELEPATHIC_MATRIX, faction_id);
 
-    if (skipdrones && !nodrones) {
+    if (sp.skipdrones && !sp.nodrones) {
         sc += 4*clamp(vals.talent, 0, 5); // consider only extra talents
-    } else if (!nodrones) {
+    } else if (!sp.nodrones) {
         sc += 4*clamp(vals.talent, -5, 5);
         sc += (vals.police >= 0 || def_val > 2 ? 4 : 2)
             * clamp(vals.police, (def_val > 2 ? -10 : -5), 3);
         if (vals.police < -2) {
-            sc -= (vals.police < -3 ? 2 : 1) * def_val
-                * (has_aircraft(faction_id) ? 2 : 1);
+            sc -= (vals.police < -3 ? 2 : 1) * def_val * (sp.aircraft ? 2 : 1);
         }
-        if (has_project(FAC_LONGEVITY_VACCINE, faction_id) && sf == SOCIAL_C_ECONOMICS) {
-            sc += (sm == SOCIAL_M_PLANNED ? 10 : 0);
-            sc += (sm == SOCIAL_M_SIMPLE || sm == SOCIAL_M_GREEN ? 5 : 0);
+        if (sp.longevity) {
+            sc += (soc.economics == SOCIAL_M_PLANNED ? 10 : 0);
+            sc += (soc.economics == SOCIAL_M_SIMPLE || soc.economics == SOCIAL_M_GREEN ? 5 : 0);
         }
-        int drone_score = 3 + (m->rule_drone > 0) - (m->rule_talent > 0) - (sphere ? 1 : 0);
         if (*SunspotDuration > 1 && *DiffLevel >= DIFF_LIBRARIAN
         && un_charter() && vals.police >= 0) {
-            sc += 3*drone_score;
+            sc += 3*sp.drone_score;
         }
         if (!un_charter() && vals.police >= 0) {
-            sc += 2*drone_score;
+            sc += 2*sp.drone_score;
         }
     }
-    if (!has_project(FAC_CLONING_VATS, faction_id)) {
-        if (pop_boom && vals.growth + (creche ? 2 : 0) >= GrowthPopBoom) {
+    if (!sp.cloning_vats) {
+        if (pop_boom && vals.growth + (sp.creche ? 2 : 0) >= GrowthPopBoom) {
             sc += 20;
         }
         if (vals.growth < -2) {
@@ -1299,8 +1374,8 @@ static int social_score(int faction_id, int sf, int sm, bool pop_boom) {
         sc += 3*clamp(vals.planet, -3, 0); // penalty for reduced fungus yield
     }
     sc += max(2, (f->SE_planet_base > 0 ? 5 : 2) + m->rule_psi/10
-        + (has_project(FAC_MANIFOLD_HARMONICS, faction_id) ? 6 : 0)) * clamp(vals.planet, -3, 3);
-    sc += max(2, 1 + def_val + probe_mod + 2*f->AI_power + 2*f->AI_fight)
+        + (sp.manifold ? 6 : 0)) * clamp(vals.planet, -3, 3);
+    sc += max(2, 1 + def_val + sp.probe_mod + 2*f->AI_power + 2*f->AI_fight)
         * clamp(vals.probe, -2, 3);
     sc += (2*clamp(vals.industry, -3, 5) - 8*mineral_factor(faction_id, vals.industry));
 
@@ -1310,15 +1385,16 @@ static int social_score(int faction_id, int sf, int sm, bool pop_boom) {
     }
 
     int psy_val = f->social_psych[clamp(vals.talent + 3, 0, 7)][clamp(vals.police + 5, 0, 8)];
-    int psy_mod = psy_val / base_val;
+    int psy_mod = psy_val / sp.base_val;
     int sup_val = f->social_support[clamp(vals.support + 4, 0, 7)];
-    int sup_mod = 4 * sup_val / base_val;
+    int sup_mod = 4 * sup_val / sp.base_val;
     int eff_val = f->social_effic[clamp(8 - vals.efficiency, 0, 8)];
-    int eff_mod = 2 * eff_val / base_val;
-    sc += ((skipdrones || nodrones ? 0 : psy_mod) - sup_mod - eff_mod);
+    int eff_mod = 2 * eff_val / sp.base_val;
+    sc += ((sp.skipdrones || sp.nodrones ? 0 : psy_mod) - sup_mod - eff_mod);
 
-    debug("social_values %d %d %8s psy: %d sup: %d eff: %d score: %d %s\n",
-        *CurrentTurn, faction_id, m->filename, psy_mod, sup_mod, eff_mod, sc, SocialField[sf].soc_name[sm]);
+    debug_ver("social_values %d %d %8s psy: %d sup: %d eff: %d score: %d %d %d %d %d\n",
+        *CurrentTurn, faction_id, m->filename, psy_mod, sup_mod, eff_mod, sc,
+        soc.politics, soc.economics, soc.values, soc.future);
     return sc;
 }
 
@@ -1373,37 +1449,99 @@ int __cdecl mod_social_ai(int faction_id, int a2, int a3, int a4, int a5, int a6
     }
     debug("social_params %d %d %8s defense: %d creche: %d pop_boom: %d want_pop: %3d pop_total: %3d\n",
         *CurrentTurn, faction_id, m->filename, def_value, has_creche, pop_boom, want_pop, pop_total);
-    int score_diff = 1 + (*CurrentTurn + 11*faction_id) % 6;
-    int sf = -1;
-    int sm2 = -1;
+    /*
+    Search all available combinations of social models instead of changing one category
+    at a time, since the effects of separate categories can interact with each other.
+    Larger changes are more expensive and each changed category must also satisfy
+    the minimum score difference to avoid switching models too often.
+    */
+    SocialParams sp;
+    CSocialCategory cur;
     CSocialCategory soc;
+    CSocialCategory best = {};
+    CSocialCategory second = {};
+    int avail[MaxSocialCatNum][MaxSocialModelNum];
+    int avail_num[MaxSocialCatNum] = {};
+    memcpy(&cur, &f->SE_Politics, sizeof(cur));
+    social_params(faction_id, pop_boom, sp);
+    social_cache_sync(faction_id);
 
     for (int i = 0; i < MaxSocialCatNum; i++) {
-        int sm1 = (&f->SE_Politics)[i];
-        int sc1 = social_score(faction_id, i, sm1, pop_boom);
         for (int j = 0; j < MaxSocialModelNum; j++) {
-            if (j == sm1 || !society_avail(i, j, faction_id)) {
-                continue;
-            }
-            int sc2 = social_score(faction_id, i, j, pop_boom);
-            if (sc2 - sc1 > score_diff) {
-                sf = i;
-                sm2 = j;
-                score_diff = sc2 - sc1;
-                memcpy(&soc, &f->SE_Politics, sizeof(soc));
-                *(&soc.politics + sf) = sm2;
-            }
-        }
-    }
-    int cost;
-    if (sf >= 0 && f->energy_credits > (cost = social_upheaval(faction_id, &soc))) {
-        int sm1 = (&f->SE_Politics)[sf];
-        (&f->SE_Politics_pending)[sf] = sm2;
-        f->energy_credits -= cost;
-        f->SE_upheaval_cost_paid += cost;
-        debug("social_change %d %d %8s cost: %d score: %d %s -> %s\n",
-            *CurrentTurn, faction_id, m->filename,
-            cost, score_diff, SocialField[sf].soc_name[sm1], SocialField[sf].soc_name[sm2]);
+            if (j == (&cur.politics)[i] || society_avail(i, j, faction_id)) {
+                avail[i][avail_num[i]++] = j;
+            }
+        }
+    }
+    int score_diff = 1 + (*CurrentTurn + 11*faction_id) % 6;
+    int cur_score = social_score(faction_id, cur, sp);
+    int best_score = INT_MIN;
+    int second_score = INT_MIN;
+    int best_cost = 0;
+    int evaluated = 0;
+
+    for (int a = 0; a < avail_num[0]; a++) {
+        soc.politics = avail[0][a];
+        for (int b = 0; b < avail_num[1]; b++) {
+            soc.economics = avail[1][b];
+            for (int c = 0; c < avail_num[2]; c++) {
+                soc.values = avail[2][c];
+                for (int d = 0; d < avail_num[3]; d++) {
+                    soc.future = avail[3][d];
+                    int changes = (soc.politics != cur.politics)
+                        + (soc.economics != cur.economics)
+                        + (soc.values != cur.values)
+                        + (soc.future != cur.future);
+                    if (!changes) {
+                        continue;
+                    }
+                    int cost = social_upheaval(faction_id, &soc);
+                    if (cost >= f->energy_credits) {
+                        continue;
+                    }
+                    int score = social_score(faction_id, soc, sp);
+                    evaluated++;
+                    if (score - cur_score <= changes * score_diff) {
+                        continue;
+                    }
+                    if (score > best_score) {
+                        second = best;
+                        second_score = best_score;
+                        best = soc;
+                        best_score = score;
+                        best_cost = cost;
+                    } else if (score > second_score) {
+                        second = soc;
+                        second_score = score;
+                    }
+                }
+            }
+        }
+    }
+    debug("social_search %d %d %8s evaluated: %d current: %d best: %d second: %d\n",
+        *CurrentTurn, faction_id, m->filename, evaluated, cur_score,
+        (best_score != INT_MIN ? best_score : 0), (second_score != INT_MIN ? second_score : 0));
+
+    if (best_score != INT_MIN) {
+        for (int i = 0; i < MaxSocialCatNum; i++) {
+            int sm1 = (&cur.politics)[i];
+            int sm2 = (&best.politics)[i];
+            if (sm1 != sm2) {
+                (&f->SE_Politics_pending)[i] = sm2;
+                debug("social_change %d %d %8s cost: %d score: %d %s -> %s\n",
+                    *CurrentTurn, faction_id, m->filename,
+                    best_cost, best_score - cur_score,
+                    SocialField[i].soc_name[sm1], SocialField[i].soc_name[sm2]);
+            }
+        }
+        if (second_score != INT_MIN) {
+            debug("social_second %d %d %8s score: %d %s %s %s %s\n",
+                *CurrentTurn, faction_id, m->filename, second_score - cur_score,
+                SocialField[0].soc_name[second.politics], SocialField[1].soc_name[second.economics],
+                SocialField[2].soc_name[second.values], SocialField[3].soc_name[second.future]);
+        }
+        f->energy_credits -= best_cost;
+        f->SE_upheaval_cost_paid += best_cost;
     }
     social_set(faction_id);
     design_units(faction_id);
@@ -65,6 +65,7 @@ int faction_id, int UNUSED(toggle), int is_quick_calc);
 void __cdecl social_upkeep(int faction_id);
 int __cdecl social_upheaval(int faction_id, CSocialCategory* choices);
 int __cdecl society_avail(int soc_category, int soc_model, int faction_id);
+void social_cache_reset();
 int __cdecl SocialWin_social_ai(int faction_id, int a2, int a3, int a4, int a5, int a6);
 int __cdecl mod_social_ai(int faction_id, int a2, int a3, int a4, int a5, int a6);
 int __cdecl mod_wants_to_attack(int faction_id, int faction_id_tgt, int faction_id_unk);
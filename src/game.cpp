@@ -1009,6 +1009,8 @@ void __cdecl mod_turn_upkeep() {
         init_world_config();
     }
     if (DEBUG) {
+        shadow_report();
+        arena_report();
         if (conf.debug_mode) {
             *GameState |= STATE_DEBUG_MODE;
             *GamePreferences |= PREF_ADV_FAST_BATTLE_RESOLUTION;
@@ -1825,6 +1825,15 @@ LRESULT WINAPI ModWinProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
             console_world_generate(ParseNumTable[0]);
         }
 
+    } else if (msg == WM_CHAR && wParam == 'O' && alt_key_down() && is_editor) {
+        uint32_t seed = ThinkerVars->map_random_value;
+        if (!pop_ask_number("modmenu", "MAPGEN", seed, 0)) {
+            seed = ParseNumTable[0];
+            if (!pop_ask_number("modmenu", "MAPSWEEP", 100, 0)) {
+                console_world_sweep(seed, ParseNumTable[0]);
+            }
+        }
+
     // Screen reader: Faction selection (Ctrl+F1 help)
     } else if (msg == WM_KEYDOWN && sr_is_available()
     && FactionSelectHandler::HandleKey(hwnd, msg, wParam)) {
@@ -1988,6 +1997,15 @@ LRESULT WINAPI ModWinProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
         MapWin_draw_map(MapWin, 0);
         InvalidateRect(hwnd, NULL, false);
 
+#ifdef BUILD_DEBUG
+    } else if (debug_cmd && wParam == 'k' && alt_key_down()) {
+        random_check();
+        flushlog();
+
+    } else if (debug_cmd && wParam == 'n' && alt_key_down()) {
+        tech_plan_check();
+#endif
+
     } else if (debug_cmd && wParam == 'z' && alt_key_down()) {
         int x = MapWin->iTileX, y = MapWin->iTileY;
         int base_id;
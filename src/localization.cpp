@@ -64,6 +64,7 @@ static const char* sr_defaults[SR_COUNT] = {
     /* SR_UNIT_TERRAFORM    */ ", building %s",
     /* SR_MONOLITH_USED     */ " (used)",
     /* SR_TILE_UNEXPLORED   */ "Unexplored",
+    /* SR_TILE_OUT_OF_RANGE */ "Out of range",
 
     // Scanner
     /* SR_SCAN_ALL          */ "Scanner: All",
@@ -1189,6 +1190,7 @@ static const char* sr_defaults[SR_COUNT] = {
     /* SR_COMBAT_ODDS_FAVORABLE     */ "Favorable",
     /* SR_COMBAT_ODDS_UNFAVORABLE   */ "Unfavorable",
     /* SR_COMBAT_ODDS_EVEN          */ "Even",
+    /* SR_COMBAT_WIN_CHANCE         */ "win chance %d%%",
     /* SR_COMBAT_PREVIEW            */ "Combat: %s (%s %d, %s, %d/%d HP) vs %s (%s %d, %s, %d/%d HP). Odds %d:%d.",
     /* SR_COMBAT_PREVIEW_PSI_FMT   */ "Psi combat: %s (%s, %d/%d HP) vs %s (%s, %d/%d HP). Odds %d:%d.",
     /* SR_COMBAT_PREVIEW_NO_UNIT    */ "No combat unit selected.",
@@ -1290,7 +1292,7 @@ static const char* sr_keys[SR_COUNT] = {
     "terrain_trench", "terrain_arid", "terrain_moist", "terrain_rainy",
     "terrain_high", "tile_yields", "tile_owner", "tile_in_radius",
     "tile_unowned", "tile_owner_diplo", "tile_worked", "foreign_unit_at",
-    "unit_terraform", "monolith_used", "tile_unexplored",
+    "unit_terraform", "monolith_used", "tile_unexplored", "tile_out_of_range",
     "scan_all", "scan_own_bases", "scan_enemy_bases", "scan_enemy_units",
     "scan_own_units", "scan_own_formers", "scan_fungus", "scan_pods",
     "scan_improvements", "scan_nature", "scan_not_found", "scan_no_more",
@@ -1715,7 +1717,7 @@ static const char* sr_keys[SR_COUNT] = {
     "combat_arty_result", "combat_arty_damage", "combat_arty_no_effect",
     // Combat Odds
     "combat_odds", "combat_odds_favorable", "combat_odds_unfavorable",
-    "combat_odds_even", "combat_preview", "combat_preview_psi_fmt",
+    "combat_odds_even", "combat_win_chance", "combat_preview", "combat_preview_psi_fmt",
     "combat_preview_no_unit", "combat_preview_psi", "enemy_list_help_combat",
     // Destroy Improvements (D key)
     "act_done_destroy",
@@ -61,6 +61,7 @@ enum SrStr {
     SR_UNIT_TERRAFORM,
     SR_MONOLITH_USED,
     SR_TILE_UNEXPLORED,
+    SR_TILE_OUT_OF_RANGE,
 
     // ===== Scanner =====
     SR_SCAN_ALL,
@@ -1189,6 +1190,7 @@ enum SrStr {
     SR_COMBAT_ODDS_FAVORABLE,
     SR_COMBAT_ODDS_UNFAVORABLE,
     SR_COMBAT_ODDS_EVEN,
+    SR_COMBAT_WIN_CHANCE,
     SR_COMBAT_PREVIEW,
     SR_COMBAT_PREVIEW_PSI_FMT,
     SR_COMBAT_PREVIEW_NO_UNIT,
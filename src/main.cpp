@@ -131,6 +131,10 @@ int option_handler(void* user, const char* section, const char* name, const char
         cf->world_mirror_x = atoi(value);
     } else if (MATCH("world_mirror_y")) {
         cf->world_mirror_y = atoi(value);
+    } else if (MATCH("world_threads")) {
+        cf->world_threads = atoi(value);
+    } else if (MATCH("world_compat_seeds")) {
+        cf->world_compat_seeds = atoi(value);
     } else if (MATCH("modified_landmarks")) {
         cf->modified_landmarks = atoi(value);
     } else if (MATCH("world_sea_levels")) {
@@ -304,6 +308,10 @@ int option_handler(void* user, const char* section, const char* name, const char
             cf->minimal_popups = atoi(value);
             cf->debug_verbose = !atoi(value);
         }
+    } else if (MATCH("shadow_check")) {
+        if (DEBUG) {
+            shadow_config(value);
+        }
     } else if (MATCH("skip_event")) {
         cf->skip_random_events |= 1 << clamp(atoi(value) - 1, 0, 31);
     } else if (MATCH("skip_faction")) {
@@ -67,6 +67,7 @@
 #include <limits.h>
 #include <time.h>
 #include <math.h>
+#include <float.h>
 #include <psapi.h>
 #include <set>
 #include <list>
@@ -238,6 +239,8 @@ struct Config {
     int world_polar_caps = 1;
     int world_mirror_x = 0;
     int world_mirror_y = 0;
+    int world_threads = 0;
+    int world_compat_seeds = 1;
     int modified_landmarks = 0;
     int time_warp_mod = 1;
     int time_warp_techs = 5;
@@ -395,6 +398,7 @@ struct AIPlans {
     int captured_bases = 0;
 };
 
+#include "arena.h"
 #include "engine.h"
 #include "config.h"
 #include "strings.h"
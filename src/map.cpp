@@ -424,6 +424,7 @@ void __cdecl world_alt_set(int x, int y, int altitude, int toggle) {
     memset(MapBaseSubmergedCount, 0, MaxPlayerNum * sizeof(int));
     memset(MapBaseIdClosestSubmergedVeh, 0xFF, MaxPlayerNum * sizeof(int));
     if (on_map(x, y)) {
+        move_upkeep_event(UE_TerrainChange, x, y);
         if (toggle) {
             alt_set_both(x, y, altitude);
         } else {
@@ -1231,8 +1232,9 @@ int __cdecl mod_hex_cost(int unit_id, int faction_id, int x1, int y1, int x2, in
             }
         }
     }
-    if (DEBUG && conf.magtube_movement_rate <= 0 && conf.fast_fungus_movement <= 0) {
-        assert(cost == hex_cost(unit_id, faction_id, x1, y1, x2, y2, toggle));
+    if (conf.magtube_movement_rate <= 0 && conf.fast_fungus_movement <= 0) {
+        shadow_check(SC_HexCostEngine, cost, hex_cost(unit_id, faction_id, x1, y1, x2, y2, toggle),
+            "unit: %d faction: %d %d %d -> %d %d", unit_id, faction_id, x1, y1, x2, y2);
     }
     return cost;
 }
@@ -2,6 +2,141 @@
 #include "mapgen.h"
 #include "lib/FastNoiseLite.h"
 
+extern HWND* phWnd;
+
+typedef std::function<void(int y1, int y2)> WorldRowsFunc;
+const int WorldThreadMax = 8;
+
+struct WorldRows {
+    const WorldRowsFunc* func;
+    uint32_t fpu_control;
+    int y1;
+    int y2;
+};
+
+/*
+New threads do not inherit the x87 control word, so the precision and rounding
+modes are copied from the calling thread to keep the float results identical.
+*/
+static DWORD WINAPI world_rows_thread(LPVOID param) {
+    WorldRows* rows = (WorldRows*)param;
+    _controlfp(rows->fpu_control, _MCW_PC | _MCW_RC);
+    (*rows->func)(rows->y1, rows->y2);
+    return 0;
+}
+
+static int world_thread_count() {
+    int count = conf.world_threads;
+    if (count < 1) {
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        count = info.dwNumberOfProcessors;
+    }
+    return clamp(min(count, *MapAreaY / 8), 1, WorldThreadMax);
+}
+
+/*
+Split the map rows into contiguous ranges and process each range on its own thread.
+The function must only write to tiles on its own rows and it must not call map_rand
+to keep the generated maps identical for each seed. Creating the threads takes longer
+than most single map passes, so this is only used for the noise evaluation.
+*/
+static void world_rows(const WorldRowsFunc& func) {
+    WorldRows rows[WorldThreadMax];
+    HANDLE threads[WorldThreadMax] = {};
+    uint32_t fpu_control = _controlfp(0, 0);
+    int count = world_thread_count();
+    for (int i = 0; i < count; i++) {
+        rows[i] = {&func, fpu_control, *MapAreaY * i / count, *MapAreaY * (i + 1) / count};
+    }
+    for (int i = 1; i < count; i++) {
+        threads[i] = CreateThread(NULL, 0, world_rows_thread, &rows[i], 0, NULL);
+    }
+    func(rows[0].y1, rows[0].y2);
+    for (int i = 1; i < count; i++) {
+        if (threads[i]) {
+            WaitForSingleObject(threads[i], INFINITE);
+            CloseHandle(threads[i]);
+        } else {
+            func(rows[i].y1, rows[i].y2);
+        }
+    }
+}
+
+static uint32_t world_preview_color(MAP* sq) {
+    static const uint32_t ocean[] = {0x102050, 0x183878, 0x3060a8};
+    int alt = sq->alt_level();
+    if (alt < ALT_SHORE_LINE) {
+        return ocean[alt];
+    }
+    uint32_t light = 0x101010 * (alt - ALT_SHORE_LINE);
+    if (sq->is_fungus()) {
+        return 0xa04080 + light;
+    }
+    if (sq->is_rocky()) {
+        return 0x707070 + light;
+    }
+    if (sq->is_rainy()) {
+        return 0x307028 + light;
+    }
+    if (sq->is_moist()) {
+        return 0x708840 + light;
+    }
+    return 0xa08858 + light;
+}
+
+/*
+Draw the map altitude and terrain classes directly on the main window. This is much
+faster than redrawing the map through the engine one tile at a time, so it is used
+for intermediate updates while maps are being generated. The engine redraw is done
+after the final map is complete. Returns false if the preview could not be drawn.
+*/
+static bool world_preview() {
+    const int AX = *MapAreaX;
+    const int AY = *MapAreaY;
+    HWND hwnd = *phWnd;
+    RECT rc;
+    if (!hwnd || AX <= 0 || AY <= 0 || !GetClientRect(hwnd, &rc)) {
+        return false;
+    }
+    std::vector<uint32_t> pixels(AX * AY);
+    for (int y = 0; y < AY; y++) {
+        for (int x = 0; x < AX; x++) {
+            MAP* sq = mapsq(((x ^ y) & 1) ? wrap(x - 1) : x, y);
+            pixels[y*AX + x] = (sq ? world_preview_color(sq) : 0);
+        }
+    }
+    // Map squares are twice as wide as they are tall on the screen
+    int width = rc.right - rc.left;
+    int height = rc.bottom - rc.top;
+    double scale = min(width / (2.0 * AX), 1.0 * height / AY);
+    int w = (int)(2 * AX * scale);
+    int h = (int)(AY * scale);
+    BITMAPINFO info = {};
+    info.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+    info.bmiHeader.biWidth = AX;
+    info.bmiHeader.biHeight = -AY; // Top-down rows
+    info.bmiHeader.biPlanes = 1;
+    info.bmiHeader.biBitCount = 32;
+    info.bmiHeader.biCompression = BI_RGB;
+    HDC hdc;
+    if (w <= 0 || h <= 0 || !(hdc = GetDC(hwnd))) {
+        return false;
+    }
+    SetStretchBltMode(hdc, COLORONCOLOR);
+    int lines = StretchDIBits(hdc, rc.left + (width - w)/2, rc.top + (height - h)/2, w, h,
+        0, 0, AX, AY, pixels.data(), &info, DIB_RGB_COLORS, SRCCOPY);
+    ReleaseDC(hwnd, hdc);
+    return lines > 0;
+}
+
+
+static int world_bridge_count = 0;
+static bool world_preview_only = false;
+static bool landmark_lists_valid = false;
+static PointList landmark_tiles[2];
+static uint32_t landmark_draws = 0;
+static uint32_t landmark_seed = 0;
 
 static void name_landmark(int x, int y, MapLandmark lm) {
     new_landmark(x, y, Natural[__builtin_ctz(lm)].name);
@@ -18,8 +153,68 @@ int __cdecl near_landmark(int x, int y) {
     return false;
 }
 
+/*
+Build the land and ocean tile lists in the same rows as locate_landmark samples.
+Tiles near existing landmarks are excluded using a bitmap marked around each landmark.
+*/
+static void landmark_lists_build() {
+    std::vector<bool> excluded(*MapAreaTiles, false);
+    for (int y = 0; y < *MapAreaY; y++) {
+        for (int x = y&1; x < *MapAreaX; x+=2) {
+            if (code_at(x, y)) {
+                for (auto& m : iterate_tiles(x, y, 0, TableRange[8])) {
+                    excluded[(m.x + *MapAreaX * m.y)/2] = true;
+                }
+            }
+        }
+    }
+    int y1 = (*MapAreaY > 17 ? 8 : 0);
+    int y2 = (*MapAreaY > 17 ? *MapAreaY - 8 : 1);
+    for (auto& tiles : landmark_tiles) {
+        tiles.clear();
+    }
+    landmark_draws = 0;
+    for (int y = y1; y < y2; y++) {
+        for (int x = y&1; x < *MapAreaX; x+=2) {
+            if (!excluded[(x + *MapAreaX * y)/2]) {
+                landmark_tiles[is_ocean(mapsq(x, y))].push_back({x, y});
+            }
+        }
+    }
+    landmark_lists_valid = true;
+}
+
+/*
+Sample a landmark location from the precomputed tile lists. Each tile is checked again
+when it is chosen and removed from the list if it is no longer valid, since the map and
+the placed landmarks change in between the calls. Draws use a separate random stream
+keyed by the map seed so that they do not shift the map_rand sequence.
+*/
+static bool landmark_sample(int* x, int* y, bool ocean) {
+    if (!landmark_lists_valid) {
+        landmark_lists_build();
+    }
+    PointList& tiles = landmark_tiles[ocean];
+    while (!tiles.empty()) {
+        int i = stream_get(RS_Landmark, landmark_seed, landmark_draws++, tiles.size());
+        Point p = tiles[i];
+        MAP* sq = mapsq(p.x, p.y);
+        if (sq && is_ocean(sq) == ocean && !near_landmark(p.x, p.y)) {
+            *x = p.x;
+            *y = p.y;
+            return true;
+        }
+        tiles[i] = tiles.back();
+        tiles.pop_back();
+    }
+    return false;
+}
+
 bool locate_landmark(int* x, int* y, bool ocean) {
     int attempts = 0;
+    if (!mapsq(*x, *y) && !conf.world_compat_seeds) {
+        return landmark_sample(x, y, ocean);
+    }
     if (!mapsq(*x, *y)) {
         do {
             if (*MapAreaY > 17) {
@@ -56,7 +251,7 @@ void __cdecl mod_world_rocky() {
                 && sq->code_at() != 19
                 && sq->code_at() != 20)) {
                     int value = mod_minerals_at(x, y);
-                    assert(value == minerals_at(x, y));
+                    shadow_check(SC_MineralsAt, value, minerals_at(x, y), "%d %d", x, y);
                     rocky_set(x, y, value);
                     if (!(sq->landmarks & LM_FRESH) || !is_ocean(sq)) {
                         if (is_ocean(sq)) {
@@ -77,6 +272,12 @@ void __cdecl mod_world_rocky() {
     }
 }
 
+/*
+The number of riverbeds is small compared to the map size (usually less than one
+per hundred tiles), so the probes below are cheaper than precomputing neighbourhood
+altitude or river source fields for the whole map. Probes near existing sources
+also stop at the first source found in TableRange[4].
+*/
 void __cdecl mod_world_riverbeds() {
     for (int i = 0; i < *MapAreaTiles; i++) {
         (*MapTiles)[i].items &= ~BIT_RIVER_SRC;
@@ -141,7 +342,7 @@ void __cdecl mod_world_shorelines() {
             }
         }
     }
-    if ((*GameState & STATE_OMNISCIENT_VIEW) && *WorldAddTemperature) {
+    if ((*GameState & STATE_OMNISCIENT_VIEW) && *WorldAddTemperature && !world_preview()) {
         MapWin_clear_terrain(MapWin);
         draw_map(1);
     }
@@ -787,28 +988,130 @@ static void mod_world_fungus(FastNoiseLite& noise) {
 
 void __cdecl mod_world_build() {
     static uint32_t seed = random_state();
+    landmark_lists_valid = false;
+    seed += pair_hash(seed, GetTickCount());
     if (!conf.new_world_builder) {
+        // Map seed is not known for the original builder but landmarks still need a unique stream
         ThinkerVars->map_random_value = 0;
+        landmark_seed = seed;
         world_build();
         return;
     }
-    seed += pair_hash(seed, GetTickCount());
     world_generate(seed);
 }
 
+/*
+Prepare the scenario editor map for generating new maps. When preview is set,
+intermediate maps are only drawn with world_preview until world_editor_end.
+Returns false if the editor is not active with omniscient view.
+*/
+static bool world_editor_begin(bool preview) {
+    if (!(*GameState & STATE_SCENARIO_EDITOR && *GameState & STATE_OMNISCIENT_VIEW)) {
+        return false;
+    }
+    *VehCount = 0;
+    *BaseCount = 0;
+    MapWin->fUnitNotViewMode = 0;
+    MapWin->iUnit = -1;
+    *GameState |= STATE_UNK_4;
+    *GameState &= ~STATE_OMNISCIENT_VIEW;
+    world_preview_only = preview;
+    return true;
+}
+
+static void world_editor_end() {
+    if (world_preview_only) {
+        world_preview_only = false;
+        MapWin_clear_terrain(MapWin);
+    }
+    *GameState |= STATE_OMNISCIENT_VIEW;
+    draw_map(1);
+    GraphicWin_redraw(WorldWin);
+}
+
 void console_world_generate(uint32_t seed) {
-    if (*GameState & STATE_SCENARIO_EDITOR && *GameState & STATE_OMNISCIENT_VIEW) {
-        *VehCount = 0;
-        *BaseCount = 0;
-        MapWin->fUnitNotViewMode = 0;
-        MapWin->iUnit = -1;
-        *GameState |= STATE_UNK_4;
-        *GameState &= ~STATE_OMNISCIENT_VIEW;
+    if (world_editor_begin(false)) {
         world_generate(seed);
-        *GameState |= STATE_OMNISCIENT_VIEW;
-        draw_map(1);
-        GraphicWin_redraw(WorldWin);
+        world_editor_end();
+    }
+}
+
+/*
+Write the map contours as a grayscale PGM image. The odd tiles in between
+the valid map squares are filled from the tile on their left side.
+*/
+static bool world_write_pgm(const char* filename) {
+    FILE* f = fopen(filename, "wb");
+    if (!f) {
+        return false;
+    }
+    std::vector<uint8_t> pixels(*MapAreaX * *MapAreaY);
+    for (int y = 0; y < *MapAreaY; y++) {
+        for (int x = 0; x < *MapAreaX; x++) {
+            MAP* sq = mapsq(((x ^ y) & 1) ? wrap(x - 1) : x, y);
+            pixels[y * *MapAreaX + x] = (sq ? sq->contour : 0);
+        }
+    }
+    fprintf(f, "P5\n%d %d\n255\n", *MapAreaX, *MapAreaY);
+    fwrite(pixels.data(), 1, pixels.size(), f);
+    fclose(f);
+    return true;
+}
+
+/*
+Generate consecutive map seeds in scenario editor mode and append statistics
+for each map into mapgen_sweep.txt for tuning the world_* config options.
+Contour images are also saved for each seed on short sweeps of up to 16 maps.
+*/
+void console_world_sweep(uint32_t seed, int count) {
+    bool images = count <= 16;
+    count = clamp(count, 1, 10000);
+    if (!world_editor_begin(true)) {
+        return;
+    }
+    FILE* f = fopen("mapgen_sweep.txt", "a");
+    if (!f) {
+        world_editor_end();
+        return;
+    }
+    fprintf(f, "seed,size,ocean,land_pct,continents,largest,bridges,rivers,time_ms\n");
+
+    for (int i = 0; i < count; i++) {
+        uint32_t value = seed + i;
+        int land = 0;
+        int rivers = 0;
+        int largest = 0;
+        std::set<int> regions;
+        uint32_t start = GetTickCount();
+        world_generate(value);
+        uint32_t time_ms = GetTickCount() - start;
+
+        for (int y = 0; y < *MapAreaY; y++) {
+            for (int x = y&1; x < *MapAreaX; x+=2) {
+                MAP* sq = mapsq(x, y);
+                if (!is_ocean(sq)) {
+                    land++;
+                    regions.insert(sq->region);
+                }
+                if (sq->items & BIT_RIVER_SRC) {
+                    rivers++;
+                }
+            }
+        }
+        for (int region : regions) {
+            largest = max(largest, (int)Continents[region].tile_count);
+        }
+        fprintf(f, "%u,%d,%d,%.1f,%d,%d,%d,%d,%u\n",
+            value, *MapSizePlanet, *MapOceanCoverage, 100.0 * land / max(1, *MapAreaTiles),
+            (int)regions.size(), largest, world_bridge_count, rivers, time_ms);
+        if (images) {
+            char filename[64];
+            snprintf(filename, sizeof(filename), "mapgen_%u.pgm", value);
+            world_write_pgm(filename);
+        }
     }
+    fclose(f);
+    world_editor_end();
 }
 
 void world_generate(uint32_t seed) {
@@ -817,6 +1120,8 @@ void world_generate(uint32_t seed) {
     }
     MAP* sq;
     map_wipe();
+    landmark_lists_valid = false;
+    landmark_seed = seed;
     ThinkerVars->map_random_value = seed;
     FastNoiseLite noise;
     noise.SetNoiseType(FastNoiseLite::NoiseType_OpenSimplex2S);
@@ -844,7 +1149,7 @@ void world_generate(uint32_t seed) {
             MapSizePlanet[i] = clamp(MapSizePlanet[i], 0, 2);
         }
     }
-    if (*GameState & STATE_OMNISCIENT_VIEW) {
+    if (*GameState & STATE_OMNISCIENT_VIEW && !world_preview()) {
         MapWin_clear_terrain(MapWin);
         draw_map(1);
     }
@@ -861,20 +1166,21 @@ void world_generate(uint32_t seed) {
     const float Warea = (conf.world_continents && *MapAreaY >= 32 ? 144.0f : 240.0f)
         / clamp(*MapAreaSqRoot, 120, 240);
 
-    for (y = 0; y < *MapAreaY; y++) {
-        float Wcaps = 1.0f - min(1.0f, (min(y, *MapAreaY - y) / (max(1.0f, *MapAreaY * 0.2f))));
+    world_rows([&](int y1, int y2) {
+        for (int ty = y1; ty < y2; ty++) {
+            float Wcaps = 1.0f - min(1.0f, (min(ty, *MapAreaY - ty) / (max(1.0f, *MapAreaY * 0.2f))));
 
-        for (x = y&1; x < *MapAreaX; x+=2) {
-            float value = world_fractal(noise, Warea, x, y) + Wmid - 0.5f*Wcaps;
-            if (value > 0) {
-                value = value * Wland;
-            } else {
-                value = value * Wsea;
+            for (int tx = ty&1; tx < *MapAreaX; tx+=2) {
+                float value = world_fractal(noise, Warea, tx, ty) + Wmid - 0.5f*Wcaps;
+                if (value > 0) {
+                    value = value * Wland;
+                } else {
+                    value = value * Wsea;
+                }
+                mapsq(tx, ty)->contour = clamp((int)(L + L*value), 0, 255);
             }
-            sq = mapsq(x, y);
-            sq->contour = clamp((int)(L + L*value), 0, 255);
         }
-    }
+    });
     if (conf.world_mirror_x) {
         const int ky = 2 - (*MapAreaY & 1);
         for (y = 0; y < *MapAreaY/2; y++) {
@@ -927,38 +1233,72 @@ void world_generate(uint32_t seed) {
     mod_world_linearize_contours();
     mod_world_shorelines();
     Path_continents(Paths);
-    Points bridges;
+    /*
+    Land tiles next to two or more large ocean regions are turned into bridges.
+    Each ocean tile is assigned a region bit and the masks for the 12 nearby tiles
+    are combined from two row masks: left and right neighbours (x-1, x+1) on odd
+    offset rows and three tiles (x-2, x, x+2) on even offset rows. Region bits are
+    kept in 32 bits so that the masks match the earlier version with int shifts.
+    */
+    const int width = *MapAreaX;
+    std::vector<uint32_t> sea_bits(width * *MapAreaY, 0);
+    std::vector<uint32_t> pair_bits(width * *MapAreaY, 0);
+    std::vector<uint32_t> triple_bits(width * *MapAreaY, 0);
+    PointList bridges;
+    uint32_t bridge_time = GetTickCount();
 
+    auto bit_at_x = [&](int row, int tx) {
+        tx = wrap(tx);
+        return (tx >= 0 && tx < width ? sea_bits[row + tx] : 0u);
+    };
+    for (y = 0; y < *MapAreaY; y++) {
+        for (x = y&1; x < width; x+=2) {
+            sq = mapsq(x, y);
+            if (is_ocean(sq) && Continents[sq->region].tile_count >= 30) {
+                sea_bits[y * width + x] = 1u << (sq->region & 0x1f);
+            }
+        }
+    }
+    for (y = 0; y < *MapAreaY; y++) {
+        int row = y * width;
+        for (x = 0; x < width; x++) {
+            pair_bits[row + x] = bit_at_x(row, x - 1) | bit_at_x(row, x + 1);
+            triple_bits[row + x] = bit_at_x(row, x - 2) | sea_bits[row + x]
+                | bit_at_x(row, x + 2);
+        }
+    }
     for (y = 3; y < *MapAreaY - 3; y++) {
-        for (x = y&1; x < *MapAreaX; x+=2) {
+        for (x = y&1; x < width; x+=2) {
             sq = mapsq(x, y);
             if (is_ocean(sq)) {
                 continue;
             }
-            uint64_t sea = 0;
             int land_count = Continents[sq->region].tile_count;
             if (conf.world_islands_mod > 0) {
                 if (land_count < conf.world_islands_mod && land_count < *MapAreaTiles/8) {
-                    bridges.insert({x, y});
+                    bridges.push_back({x, y});
                     if (DEBUG) mapdata[{x, y}].overlay = -1;
                     continue;
                 }
             }
-            for (auto& m : iterate_tiles(x, y, 1, 13)) {
-                if (is_ocean(m.sq)) {
-                    if (Continents[m.sq->region].tile_count >= 30) {
-                        sea |= 1 << (m.sq->region & 0x3f);
-                    }
-                }
-            }
+            uint32_t sea = triple_bits[(y - 2) * width + x]
+                | pair_bits[(y - 1) * width + x]
+                | triple_bits[y * width + x]
+                | pair_bits[(y + 1) * width + x]
+                | triple_bits[(y + 2) * width + x];
             if (__builtin_popcount(sea) > 1) {
                 if (land_count > *MapAreaTiles/8 || pair_hash(seed^(x/8), y/8) & 1) {
-                    bridges.insert({x, y});
+                    bridges.push_back({x, y});
                     if (DEBUG) mapdata[{x, y}].overlay = -2;
                 }
             }
         }
     }
+    // Keep the same altitude change order as with the earlier set of points
+    std::sort(bridges.begin(), bridges.end());
+    bridge_time = GetTickCount() - bridge_time;
+    debug("world_bridges %d time: %u\n", (int)bridges.size(), bridge_time);
+    world_bridge_count = bridges.size();
     for (auto& p : bridges) {
         world_alt_set(p.x, p.y, ALT_OCEAN, 1);
         world_alt_set(p.x, p.y, ALT_OCEAN_SHELF, 1);
@@ -1053,7 +1393,7 @@ void world_generate(uint32_t seed) {
     world_climate(); // Run Path::continents
     mod_world_rocky();
 
-    if (!*GameHalted) {
+    if (!*GameHalted && !(world_preview_only && world_preview())) {
         MapWin_clear_terrain(MapWin);
     }
     flushlog();
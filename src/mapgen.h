@@ -33,5 +33,6 @@ void __cdecl mod_world_ridge(int x, int y);
 void __cdecl mod_world_geothermal(int x, int y);
 void __cdecl mod_world_build();
 void console_world_generate(uint32_t seed);
+void console_world_sweep(uint32_t seed, int count);
 void world_generate(uint32_t seed);
 
@@ -23,8 +23,8 @@ to the square chosen by escape_move.
 PMTable mapdata;
 NodeSet mapnodes;
 static Points nonally;
-static std::set<int> region_enemy;
-static std::set<int> region_probe;
+static arena_set<int> region_enemy;
+static arena_set<int> region_probe;
 static const int VehRemoveTurns = 60;
 
 
@@ -35,13 +35,6 @@ static void adjust_former(int x, int y, int range, int value) {
     }
 }
 
-static void adjust_safety(int x, int y, int range, int value) {
-    assert(range > 0 && range < 9);
-    for (const auto& m : iterate_tiles(x, y, 0, TableRange[range])) {
-        mapdata[{m.x, m.y}].safety += value;
-    }
-}
-
 static void adjust_shore(int x, int y, int range, int value) {
     assert(range > 0 && range < 9);
     for (const auto& m : iterate_tiles(x, y, 0, TableRange[range])) {
@@ -49,13 +42,6 @@ static void adjust_shore(int x, int y, int range, int value) {
     }
 }
 
-static void adjust_unit_near(int x, int y, int range, int value) {
-    assert(range > 0 && range < 9);
-    for (const auto& m : iterate_tiles(x, y, 0, TableRange[range])) {
-        mapdata[{m.x, m.y}].unit_near += value;
-    }
-}
-
 static void adjust_enemy_near(int x, int y, int range, int value) {
     assert(range > 0 && range < 9);
     for (const auto& m : iterate_tiles(x, y, 0, TableRange[range])) {
@@ -67,6 +53,325 @@ static void adjust_enemy_near(int x, int y, int range, int value) {
     }
 }
 
+/*
+Influence values for safety, unit_near and enemy_near are deposited per unit
+during move_upkeep and spread to the surrounding tiles in one batch. The square
+kernel of iterate_tiles is separable along the two diagonal directions of the map
+grid, so the deposits are summed first along (+1,+1) lines including tiles past
+the map edges and then along (+1,-1) lines. Only tiles within range of some
+deposit are written to mapdata, which keeps the same set of entries as adding
+the values tile by tile. Range zero deposits only change the unit tile.
+
+The batch passes cost a fixed amount per map tile and mapdata entry for each field
+and range, so they are only used when the deposits cover the map many times over.
+Measured on a standalone build with random deposits of range 1-5, adding deposits
+separately was faster until they covered about 20-60 times the map tiles (for example
+1024 deposits on a 112x56 map: 2.3 ms vs 4.4 ms, 4096 deposits: 10.9 ms vs 5.2 ms),
+so InfluenceBatchRatio is set in between.
+
+Deposits are only added to mapdata, so move_upkeep_refresh can move the deposits
+of a single unit by adding its deposits on the new tile and negated deposits on the old tile.
+*/
+struct InfluenceItem {
+    int x;
+    int y;
+    int range;
+    int value;
+    int PInfo::* field;
+};
+
+static int PInfo::* const InfluenceFields[] = {
+    &PInfo::safety, &PInfo::unit_near, &PInfo::enemy_near, &PInfo::enemy};
+static const int InfluenceFieldNum = 4;
+static const int InfluenceBatchRatio = 32;
+
+/*
+Journal of map events since the last full move_upkeep for move_upkeep_faction.
+Enemy vehicle kills are handled in veh_kill_lift. Base and terrain events are applied
+as local patches to the values move_upkeep derived from the same tile (base safety,
+former and near base values, shore values), which are recorded in upkeep_bases and
+upkeep_ocean. Road plans, enemy distances and the cover ranking are not patched and
+are only updated on the next full upkeep.
+Player units managed by move_upkeep_refresh are journaled in upkeep_moves with
+the tile where their influence deposits were applied.
+*/
+struct UpkeepEvent {
+    UpkeepEventType type;
+    int x;
+    int y;
+};
+
+struct UpkeepMove {
+    int veh_id;
+    int x;
+    int y;
+    int unit_id;
+    int faction_id;
+};
+
+struct UpkeepBase {
+    int safety;
+    int former;
+};
+
+static int move_upkeep_turn = -1;
+static std::vector<UpkeepEvent> upkeep_journal;
+static std::vector<UpkeepMove> upkeep_moves;
+static std::unordered_map<Point, UpkeepBase> upkeep_bases;
+static std::vector<uint8_t> upkeep_ocean;
+static std::vector<UpkeepEvent> site_journal;
+static int site_faction = -1;
+
+void move_upkeep_event(UpkeepEventType type, int x, int y) {
+    if (type != UE_VehKill) {
+        combat_cache_reset();
+        if (site_faction >= 0) {
+            site_journal.push_back({type, x, y});
+        }
+    }
+    if (move_upkeep_faction >= 0) {
+        upkeep_journal.push_back({type, x, y});
+    }
+}
+
+static void influence_veh(std::vector<InfluenceItem>& items, int faction_id, VEH* veh) {
+    int triad = veh->triad();
+    if (veh->faction_id == faction_id) {
+        if (veh->is_combat_unit()) {
+            items.push_back({veh->x, veh->y, 1, 40, &PInfo::safety});
+            items.push_back({veh->x, veh->y, 0, 60, &PInfo::safety});
+        }
+        items.push_back({veh->x, veh->y, 3, (triad != TRIAD_AIR ? 2 : 1), &PInfo::unit_near});
+
+    } else if (at_war(faction_id, veh->faction_id)) {
+        int value = (veh->is_combat_unit() ? -100 : (veh->is_probe() ? -24 : -12));
+        int range = (veh->speed() > 1 ? 3 : 2) + (triad == TRIAD_AIR ? 2 : 0);
+        if (value == -100) {
+            items.push_back({veh->x, veh->y, range, value/(range > 2 ? 4 : 8), &PInfo::safety});
+        }
+        items.push_back({veh->x, veh->y, 0, 1, &PInfo::enemy});
+        items.push_back({veh->x, veh->y, 1, value, &PInfo::safety});
+        if (veh->unit_id != BSC_FUNGAL_TOWER) {
+            items.push_back({veh->x, veh->y, 3, 1, &PInfo::enemy_near});
+        }
+
+    } else if (has_pact(faction_id, veh->faction_id) && veh->is_combat_unit()) {
+        items.push_back({veh->x, veh->y, 1, 20, &PInfo::safety});
+        items.push_back({veh->x, veh->y, 0, 30, &PInfo::safety});
+    }
+}
+
+/*
+Add each deposit separately. This is also the reference version for debug checks.
+*/
+template <class Table>
+static void influence_apply(Table& tbl, const std::vector<InfluenceItem>& items, bool rank) {
+    for (const auto& item : items) {
+        assert(item.range >= 0 && item.range <= MaxTableRange);
+        for (const auto& m : iterate_tiles(item.x, item.y, 0, TableRange[item.range])) {
+            tbl[{m.x, m.y}].*item.field += item.value;
+            if (rank && item.field == &PInfo::enemy_near && m.i > 0 && m.i < 9 && item.value > 0) {
+                tbl[{m.x, m.y}].enemy_rank += item.value;
+            }
+        }
+    }
+}
+
+static void influence_spread(const std::vector<int>& src, std::vector<int>& dst, int range) {
+    const int w = *MapAreaX;
+    const int h = *MapAreaY;
+    const int pad_x = (map_is_flat() ? range : 0);
+    const int pw = w + 2*pad_x;
+    const int ph = h + 2*range;
+    std::vector<int> line(pw*ph, 0);
+
+    for (int py = 0; py < ph; py++) {
+        for (int px = (py + range + pad_x)&1; px < pw; px += 2) {
+            int x = px - pad_x;
+            int y = py - range;
+            int sum = 0;
+            for (int i = -range; i <= range; i++) {
+                int x2 = wrap(x + i);
+                int y2 = y + i;
+                if (x2 >= 0 && y2 >= 0 && x2 < w && y2 < h) {
+                    sum += src[x2 + w*y2];
+                }
+            }
+            line[px + pw*py] = sum;
+        }
+    }
+    for (int y = 0; y < h; y++) {
+        for (int x = y&1; x < w; x += 2) {
+            int sum = 0;
+            for (int i = -range; i <= range; i++) {
+                int px = wrap(x + i) + pad_x;
+                int py = y - i + range;
+                if (px >= 0 && px < pw) {
+                    sum += line[px + pw*py];
+                }
+            }
+            dst[x + w*y] = sum;
+        }
+    }
+}
+
+/*
+Add the deposits to the table with the batch passes. The enemy_rank ring is only
+updated when rank is set, since move_upkeep replaces it with the cover ranking afterwards.
+*/
+template <class Table>
+static void influence_batch(Table& tbl, const std::vector<InfluenceItem>& items, bool rank) {
+    const int w = *MapAreaX;
+    const int size = *MapAreaX * *MapAreaY;
+    std::vector<int> src(size);
+    std::vector<int> dst(size);
+    std::vector<int> hits(size, 0);
+    bool found = false;
+
+    for (int range = 0; range <= MaxTableRange; range++) {
+        int count = 0;
+        std::fill(src.begin(), src.end(), 0);
+        for (const auto& item : items) {
+            if (item.range == range) {
+                src[item.x + w*item.y]++;
+                count++;
+            }
+        }
+        if (count > 0) {
+            influence_spread(src, dst, range);
+            for (int i = 0; i < size; i++) {
+                hits[i] += dst[i];
+            }
+            found = true;
+        }
+    }
+    if (!found) {
+        return;
+    }
+    // Create the same entries as the reference version before adding any values
+    for (int y = 0; y < *MapAreaY; y++) {
+        for (int x = y&1; x < w; x += 2) {
+            if (hits[x + w*y]) {
+                tbl[{x, y}];
+            }
+        }
+    }
+    for (int k = 0; k < InfluenceFieldNum + rank; k++) {
+        for (int range = 0; range <= MaxTableRange; range++) {
+            bool deposit = false;
+            std::fill(src.begin(), src.end(), 0);
+            for (const auto& item : items) {
+                if (k < InfluenceFieldNum && item.field == InfluenceFields[k] && item.range == range) {
+                    src[item.x + w*item.y] += item.value;
+                    deposit = true;
+                } else if (k == InfluenceFieldNum && item.field == &PInfo::enemy_near
+                && item.value > 0 && item.range > 0 && range == 1) {
+                    src[item.x + w*item.y] += item.value;
+                    deposit = true;
+                }
+            }
+            if (!deposit) {
+                continue;
+            }
+            influence_spread(src, dst, range);
+            for (auto& m : tbl) {
+                int i = m.first.x + w*m.first.y;
+                if (k < InfluenceFieldNum) {
+                    m.second.*InfluenceFields[k] += dst[i];
+                } else {
+                    // Ring around the deposit, the center tile is excluded
+                    m.second.enemy_rank += dst[i] - src[i];
+                }
+            }
+        }
+    }
+}
+
+static void influence_flush(PMTable& tbl, const std::vector<InfluenceItem>& items, bool rank) {
+    int tiles = 0;
+    for (const auto& item : items) {
+        tiles += TableRange[item.range];
+    }
+    if (tiles < InfluenceBatchRatio * *MapAreaTiles) {
+        influence_apply(tbl, items, rank);
+    } else {
+        influence_batch(tbl, items, rank);
+    }
+}
+
+/*
+Compare the batched influence update against the reference version on sampled upkeeps.
+Random deposits are included on some turns to cover all kernel ranges and map edges.
+The tables are allocated from the heap since arena memory is not released until reset.
+*/
+static void influence_check(const std::vector<InfluenceItem>& items) {
+    std::vector<InfluenceItem> tests(items);
+    if (!(*CurrentTurn % 8)) {
+        uint32_t seed = *CurrentTurn * 2654435761u;
+        for (int i = 0; i < 64; i++) {
+            seed = seed * 1103515245u + 12345u;
+            int y = (seed >> 8) % *MapAreaY;
+            int x = ((seed >> 4) % *MapAreaX) & ~1;
+            seed = seed * 1103515245u + 12345u;
+            tests.push_back({x + (y&1), y, (int)((seed >> 8) % (MaxTableRange + 1)),
+                (int)((seed >> 16) % 201) - 100, InfluenceFields[(seed >> 4) % InfluenceFieldNum]});
+        }
+    }
+    std::unordered_map<Point, PInfo> ref;
+    std::unordered_map<Point, PInfo> out;
+    influence_apply(ref, tests, true);
+    influence_batch(out, tests, true);
+    int changes = abs((int)ref.size() - (int)out.size());
+    for (const auto& m : ref) {
+        auto it = out.find(m.first);
+        if (it == out.end()) {
+            changes++;
+            continue;
+        }
+        for (int k = 0; k < InfluenceFieldNum; k++) {
+            changes += it->second.*InfluenceFields[k] != m.second.*InfluenceFields[k];
+        }
+        changes += it->second.enemy_rank != m.second.enemy_rank;
+    }
+    shadow_verify(SC_Influence, !changes, "items: %d changes: %d", (int)tests.size(), changes);
+}
+
+/*
+Add the deposits of the journaled unit on its journaled tile with the given sign.
+*/
+static void upkeep_move_items(std::vector<InfluenceItem>& items, const UpkeepMove& m, int sign) {
+    VEH veh = Vehs[m.veh_id];
+    size_t start = items.size();
+    veh.x = m.x;
+    veh.y = m.y;
+    influence_veh(items, move_upkeep_faction, &veh);
+    for (size_t i = start; i < items.size(); i++) {
+        items[i].value *= sign;
+    }
+}
+
+/*
+Remove the deposits of a journaled unit when it is killed and update the journaled
+vehicle ids after the vehicle array is compacted.
+*/
+static void upkeep_move_kill(int veh_id) {
+    std::vector<InfluenceItem> diff;
+    for (auto it = upkeep_moves.begin(); it != upkeep_moves.end();) {
+        if (it->veh_id == veh_id) {
+            upkeep_move_items(diff, *it, -1);
+            it = upkeep_moves.erase(it);
+        } else {
+            if (it->veh_id > veh_id) {
+                it->veh_id--;
+            }
+            ++it;
+        }
+    }
+    if (!diff.empty()) {
+        influence_flush(mapdata, diff, false);
+    }
+}
+
 static bool reg_enemy_at(int region, bool is_probe) {
     return is_probe ? region_probe.count(region) : region_enemy.count(region);
 }
@@ -114,7 +419,133 @@ static bool veh_base_check(VEH* veh) {
     return false;
 }
 
+/*
+Refuel distance field for air units, built once per turn for the moving faction.
+Each tile holds the range to the nearest refuel point (friendly base, airbase or
+carrier). An aircraft with fuel left for n tiles can reach tile t and still return
+for refuelling when map_range(unit, t) + air_refuel[t] <= n, so the reachable set
+for every fuel budget follows from this single field. Carriers are sampled when the
+field is built and moving them later in the turn is not tracked.
+*/
+const int16_t AirRefuelNone = 0x7fff;
+static int air_refuel_faction = -1;
+static int air_refuel_turn = -1;
+static int air_refuel_bases = -1;
+static std::vector<int16_t> air_refuel;
+
+static void air_refuel_reset() {
+    air_refuel_faction = -1;
+    air_refuel.clear();
+}
+
+static bool air_refuel_tile(int x, int y, int faction_id, MAP* sq) {
+    if (sq->is_base()) {
+        return sq->owner == faction_id || has_pact(faction_id, sq->owner);
+    }
+    return sq->items & BIT_AIRBASE && !non_ally_in_tile(x, y, faction_id);
+}
+
+static void air_refuel_build(int faction_id) {
+    std::vector<int> queue;
+    air_refuel_faction = faction_id;
+    air_refuel_turn = *CurrentTurn;
+    air_refuel_bases = *BaseCount;
+    air_refuel.assign(*MapAreaTiles, AirRefuelNone);
+
+    for (int y = 0; y < *MapAreaY; y++) {
+        for (int x = y&1; x < *MapAreaX; x += 2) {
+            MAP* sq = mapsq(x, y);
+            if (sq && sq->is_airbase() && air_refuel_tile(x, y, faction_id, sq)) {
+                queue.push_back(x + *MapAreaX*y);
+            }
+        }
+    }
+    for (int i = 0; i < *VehCount; i++) {
+        VEH* veh = &Vehs[i];
+        if ((veh->faction_id == faction_id || has_pact(faction_id, veh->faction_id))
+        && has_abil(veh->unit_id, ABL_CARRIER) && mapsq(veh->x, veh->y)) {
+            queue.push_back(veh->x + *MapAreaX*veh->y);
+        }
+    }
+    for (int k : queue) {
+        air_refuel[k/2] = 0;
+    }
+    // Breadth first search over adjacent tiles yields exactly map_range distances
+    for (size_t head = 0; head < queue.size(); head++) {
+        int x = queue[head] % *MapAreaX;
+        int y = queue[head] / *MapAreaX;
+        int dist = air_refuel[queue[head]/2] + 1;
+        for (int i = 1; i < TableRange[1]; i++) {
+            int x2, y2;
+            if (next_tile(x, y, i, &x2, &y2) && air_refuel[(x2 + *MapAreaX*y2)/2] > dist) {
+                air_refuel[(x2 + *MapAreaX*y2)/2] = dist;
+                queue.push_back(x2 + *MapAreaX*y2);
+            }
+        }
+    }
+    debug("air_refuel_build %d %d points: %d\n", *CurrentTurn, faction_id, (int)queue.size());
+}
+
+/*
+Return the range from the tile to the nearest refuel point for the faction.
+*/
+int air_refuel_dist(int faction_id, int x, int y) {
+    if (!mapsq(x, y)) {
+        return AirRefuelNone;
+    }
+    if (air_refuel_faction != faction_id || air_refuel_turn != *CurrentTurn
+    || air_refuel_bases != *BaseCount || (int)air_refuel.size() != *MapAreaTiles) {
+        air_refuel_build(faction_id);
+    }
+    int value = air_refuel[(x + *MapAreaX*y)/2];
+    if (DEBUG && shadow_sample(SC_AirRefuel)) {
+        int best = AirRefuelNone;
+        for (int i = 0; i < *BaseCount; i++) {
+            MAP* sq = mapsq(Bases[i].x, Bases[i].y);
+            if (sq && air_refuel_tile(Bases[i].x, Bases[i].y, faction_id, sq)) {
+                best = min(best, map_range(x, y, Bases[i].x, Bases[i].y));
+            }
+        }
+        shadow_verify(SC_AirRefuel, value <= best, "%d %d faction: %d value: %d base: %d",
+            x, y, faction_id, value, best);
+    }
+    return value;
+}
+
+/*
+Return how many tiles the aircraft can still fly before it has to be refuelled,
+or -1 if the unit is not limited by fuel. Missiles are excluded since they are
+expended when attacking, and so are choppers with range 1 since they only take
+damage when ending the turn outside of refuel points (see mod_turn_upkeep).
+*/
+int air_fuel_range(int veh_id) {
+    VEH* veh = &Vehs[veh_id];
+    if (veh->triad() != TRIAD_AIR || veh->is_missile() || !veh->range()
+    || (veh->range() == 1 && veh->chassis_type() == CHS_COPTER)) {
+        return -1;
+    }
+    int moves = veh_speed(veh_id, 0);
+    return max(0, veh->range() - veh->movement_turns - 1) * (moves / Rules->move_rate_roads)
+        + max(0, moves - veh->moves_spent) / Rules->move_rate_roads;
+}
+
+/*
+Check if the aircraft can reach the tile and return to any refuel point afterwards.
+*/
+bool air_reachable(int veh_id, int x, int y) {
+    VEH* veh = &Vehs[veh_id];
+    int fuel = air_fuel_range(veh_id);
+    if (fuel < 0) {
+        return true;
+    }
+    return map_range(veh->x, veh->y, x, y) + air_refuel_dist(veh->faction_id, x, y) <= fuel;
+}
+
 static bool needlejet_check(VEH* veh, int x, int y) {
+    MAP* sq = mapsq(x, y);
+    if (!sq || !sq->veh_in_tile()) {
+        return false;
+    }
     for (int i = *VehCount - 1; i >= 0; --i) {
         VEH* v = &Vehs[i];
         if (v->x == x && v->y == y && v->triad() == TRIAD_AIR
@@ -200,12 +631,29 @@ static double battle_calc(int veh_id, double value, double moves, bool reactor)
 static double battle_eval(int veh_id_atk, int veh_id_def, int moves, int move_rate, bool reactor) {
     int s1 = 0;
     int s2 = 0;
-    mod_battle_compute(veh_id_atk, veh_id_def, &s1, &s2, 0);
+    battle_compute_cached(veh_id_atk, veh_id_def, &s1, &s2, 0);
     double v1 = battle_calc(veh_id_atk, s1, (1.0 * moves) / move_rate, reactor);
     double v2 = battle_calc(veh_id_def, s2, 1.0, reactor);
     return v1/v2;
 }
 
+static double battle_win(int veh_id_atk, int veh_id_def, int moves, int move_rate) {
+    int s1 = 0;
+    int s2 = 0;
+    battle_compute_cached(veh_id_atk, veh_id_def, &s1, &s2, 0);
+    return battle_odds_veh(veh_id_atk, veh_id_def, s1 * moves / move_rate, s2);
+}
+
+/*
+Limit for the strength ratio in battle_priority based on the exact win probability.
+The ratio is capped to BattleWinCapBase + BattleWinCapScale * win, which maps certain
+loss to 0.5 and even odds to 1.5. Since the ratio is capped to 1.4 (1.6 for targets with
+offense value) afterwards anyway, the limit only changes the priority of attacks that
+have less than a 45% (55%) chance to win, and lowers it linearly with the win chance.
+*/
+static const double BattleWinCapBase = 0.5;
+static const double BattleWinCapScale = 2.0;
+
 static double battle_priority(int veh_id_atk, int veh_id_def, int dist, int moves, MAP* sq) {
     if (!sq || veh_id_atk < 0 || veh_id_atk >= *VehCount
     || veh_id_def < 0 || veh_id_def >= *VehCount) {
@@ -276,6 +724,12 @@ static double battle_priority(int veh_id_atk, int veh_id_def, int dist, int move
         move_rate,
         reactor_atk
     );
+    /*
+    Strength ratio overestimates the attack when either unit has only a few rounds left,
+    so it is also limited by the exact probability to win the combat.
+    */
+    double win = (veh1->is_probe() ? 1.0 : battle_win(veh_id_atk, veh_id_def, atk_moves, move_rate));
+    v1 = min(v1, BattleWinCapBase + BattleWinCapScale*win);
     double v2 = (sq->owner == veh1->faction_id ? (sq->is_base_radius() ? 0.15 : 0.1) : 0.0)
         + (stack_damage ? 0.025 * mapdata[{veh2->x, veh2->y}].enemy : 0)
         + min(24.0, veh2->eval_offense() + 0.5*veh2->eval_defense())
@@ -290,9 +744,9 @@ static double battle_priority(int veh_id_atk, int veh_id_def, int dist, int move
         - 0.02*mapdata[{veh2->x, veh2->y}].target;
 
     debug("combat_odds %2d %2d -> %2d %2d dist: %d cost: %d moves: %d/%d "\
-        "v1: %.4f v2: %.4f odds: %.4f | %d %d %s | %d %d %s\n",
+        "v1: %.4f v2: %.4f win: %.4f odds: %.4f | %d %d %s | %d %d %s\n",
         veh1->x, veh1->y, veh2->x, veh2->y, dist, cost, atk_moves, move_rate,
-        v1, v2, v3, veh_id_atk, veh1->faction_id, veh1->name(), veh_id_def, veh2->faction_id, veh2->name());
+        v1, v2, win, v3, veh_id_atk, veh1->faction_id, veh1->name(), veh_id_def, veh2->faction_id, veh2->name());
     return v3;
 }
 
@@ -470,8 +924,8 @@ int __cdecl mod_enemy_move(int veh_id) {
                 set_base(base_id);
             }
         }
-        if (conf.manage_player_units && move_upkeep_faction != veh->faction_id) {
-            move_upkeep(veh->faction_id, UM_Player);
+        if (conf.manage_player_units) {
+            move_upkeep_refresh(veh_id);
         }
     }
     if (thinker_move_upkeep(veh->faction_id)) {
@@ -514,6 +968,8 @@ int __cdecl mod_enemy_move(int veh_id) {
 int __cdecl veh_kill_lift(int veh_id) {
     // This function is called in veh_kill when a vehicle is removed/killed for any reason
     VEH* veh = &Vehs[veh_id];
+    move_upkeep_event(UE_VehKill, veh->x, veh->y);
+    upkeep_move_kill(veh_id);
     if (on_map(veh->x, veh->y) && at_war(move_upkeep_faction, veh->faction_id)) {
         if (mapdata[{veh->x, veh->y}].enemy > 0) {
             adjust_enemy_near(veh->x, veh->y, 3, -1);
@@ -800,6 +1256,654 @@ void update_main_region(int faction_id) {
     }
 }
 
+/*
+Faction-wide former planner. Candidate tiles are scored once per move_upkeep into
+former_tiles and idle AI formers are then matched with the best remaining jobs
+using a greedy max heap over all former and tile pairs. The claim counters in
+mapdata former are added when the scores are read, so they stay up to date.
+*/
+struct FormerTile {
+    int score; // former_tile_score without the claim counter
+    int item;
+};
+
+struct FormerJob {
+    int x;
+    int y;
+    int tx;
+    int ty;
+};
+
+struct FormerPair {
+    int score;
+    int veh_id;
+    int x;
+    int y;
+
+    bool operator<(FormerPair const& obj) const {
+        return score < obj.score || (score == obj.score && (veh_id > obj.veh_id
+            || (veh_id == obj.veh_id && (x > obj.x || (x == obj.x && y > obj.y)))));
+    }
+};
+
+static const int FormerPlanRange = 8;
+static int former_plan_faction = -1;
+static std::unordered_map<Point, FormerTile> former_tiles;
+static std::unordered_map<int, FormerJob> former_jobs;
+
+static void former_plan_reset() {
+    former_plan_faction = -1;
+    former_tiles.clear();
+    former_jobs.clear();
+}
+
+static bool former_plan_tile(int x, int y, int faction_id, MAP* sq, PInfo& mp) {
+    return !(sq->is_base()
+        || (sq->owner != faction_id && mp.roads < 1)
+        || (mp.former < 1 && mp.roads < 1)
+        || mp.safety < PM_SAFE
+        || non_ally_in_tile(x, y, faction_id));
+}
+
+static int former_plan_score(const FormerTile& tile, int x, int y) {
+    return tile.score + min(8, mapdata[{x, y}].former);
+}
+
+static void former_home(VEH* veh, int* bx, int* by) {
+    *bx = veh->x;
+    *by = veh->y;
+    if (veh->home_base_id >= 0 && Bases[veh->home_base_id].faction_id == veh->faction_id) {
+        *bx = Bases[veh->home_base_id].x;
+        *by = Bases[veh->home_base_id].y;
+    }
+}
+
+static void former_plan(int faction_id) {
+    MAP* sq;
+    former_plan_reset();
+    former_plan_faction = faction_id;
+    for (auto& m : mapdata) {
+        int x = m.first.x;
+        int y = m.first.y;
+        if ((sq = mapsq(x, y)) && former_plan_tile(x, y, faction_id, sq, m.second)) {
+            int item = select_item(x, y, faction_id, FM_Auto_Full, sq);
+            if (item >= 0) {
+                int score = former_tile_score(x, y, faction_id, sq) - min(8, m.second.former);
+                former_tiles[{x, y}] = {score, item};
+            }
+        }
+    }
+    std::priority_queue<FormerPair, arena_vector<FormerPair>> pairs;
+    for (int i = 0; i < *VehCount; i++) {
+        VEH* veh = &Vehs[i];
+        if (veh->faction_id != faction_id || !veh->is_former() || veh->plr_owner()
+        || veh->triad() != TRIAD_LAND || !(sq = mapsq(veh->x, veh->y)) || is_ocean(sq)
+        || (veh->order >= ORDER_FARM && veh->order < ORDER_MOVE_TO)
+        || !veh->at_target() || former_tiles.count({veh->x, veh->y})) {
+            continue;
+        }
+        int bx, by;
+        former_home(veh, &bx, &by);
+        for (auto& m : iterate_tiles(veh->x, veh->y, 1, TableRange[FormerPlanRange])) {
+            auto it = former_tiles.find({m.x, m.y});
+            if (it != former_tiles.end() && m.sq->region == sq->region) {
+                int score = former_plan_score(it->second, m.x, m.y)
+                    - map_range(bx, by, m.x, m.y)/2 - map_range(veh->x, veh->y, m.x, m.y)/2;
+                pairs.push({score, i, m.x, m.y});
+            }
+        }
+    }
+    Points claimed;
+    while (!pairs.empty()) {
+        FormerPair pair = pairs.top();
+        pairs.pop();
+        if (former_jobs.count(pair.veh_id) || claimed.count({pair.x, pair.y})) {
+            continue;
+        }
+        VEH* veh = &Vehs[pair.veh_id];
+        former_jobs[pair.veh_id] = {veh->x, veh->y, pair.x, pair.y};
+        claimed.insert({pair.x, pair.y});
+        debug_ver("former_plan %2d %2d -> %2d %2d score: %d %s\n",
+            veh->x, veh->y, pair.x, pair.y, pair.score, veh->name());
+    }
+    debug("former_plan %d tiles: %d jobs: %d\n",
+        faction_id, (int)former_tiles.size(), (int)former_jobs.size());
+}
+
+/*
+Return the planned job for the former if it is still valid.
+*/
+static bool former_plan_job(int veh_id, int* tx, int* ty, int* item) {
+    VEH* veh = &Vehs[veh_id];
+    auto it = former_jobs.find(veh_id);
+    if (it == former_jobs.end() || it->second.x != veh->x || it->second.y != veh->y) {
+        return false;
+    }
+    FormerJob job = it->second;
+    former_jobs.erase(it);
+    MAP* sq = mapsq(job.tx, job.ty);
+    if (!sq || !former_plan_tile(job.tx, job.ty, veh->faction_id, sq, mapdata[{job.tx, job.ty}])
+    || (*item = select_item(job.tx, job.ty, veh->faction_id, FM_Auto_Full, sq)) < 0) {
+        former_tiles.erase({job.tx, job.ty});
+        return false;
+    }
+    *tx = job.tx;
+    *ty = job.ty;
+    return true;
+}
+
+/*
+Faction-wide colony site scores. The radius values used by base_tile_score are
+stored per tile for land and sea colonies, and each map row keeps prefix sums
+of these values so that the 21 tile radius sum is read from seven row spans.
+The tile state read by site_tile_value is stored when the values are computed.
+During the turn only the tiles near journaled base and terrain events are checked
+for state changes, which covers territory changes after bases are founded, captured
+or removed and altitude changes. All values are rebuilt after each move_upkeep,
+so terraforming by the engine and treaty changes are applied on the next rebuild.
+*/
+static const int SiteRowSpan[7] = {1, 2, 3, 2, 3, 2, 1};
+static const int SiteTerrainRange = 4;
+static int site_row_len = 0;
+static std::vector<int> site_values[2];
+static std::vector<int> site_prefix[2];
+static std::vector<uint64_t> site_state;
+
+static void site_reset() {
+    site_faction = -1;
+    site_state.clear();
+    site_journal.clear();
+}
+
+static uint64_t site_tile_state(MAP* sq) {
+    return sq->items | (uint64_t)sq->climate << 32 | (uint64_t)sq->val3 << 40
+        | (uint64_t)(uint8_t)sq->owner << 48 | (uint64_t)(sq->val2 & 0xF) << 56;
+}
+
+static int site_tile_value(int x, int y, int faction_id, bool sea_colony) {
+    MAP* sq = mapsq(x, y);
+    if (!sq || sq->is_base()) {
+        return 0;
+    }
+    const int priority[][2] = {
+        {BIT_FUNGUS, -2},
+        {BIT_FARM, 2},
+        {BIT_FOREST, 2},
+        {BIT_MONOLITH, 4},
+    };
+    int bn = bonus_at(x, y);
+    int lm = sq->lm_items();
+    int alt = sq->alt_level();
+    int score = 0;
+    if (lm & ~(LM_DUNES|LM_SARGASSO|LM_UNITY)) {
+        score += (lm & LM_JUNGLE ? 3 : 2);
+    }
+    score += (bn ? (bn != RES_ENERGY ? 8 : 6) : 0);
+    if (sea_colony != (alt < ALT_SHORE_LINE) && both_non_enemy(faction_id, sq->owner)) {
+        score -= 5;
+    }
+    if (alt >= ALT_SHORE_LINE) {
+        if (sq->is_rainy()) {
+            score += 2;
+        }
+        if (sq->is_moist() && sq->is_rolling()) {
+            score += 2;
+        }
+        if (sq->items & BIT_RIVER) {
+            score++;
+        }
+    }
+    for (const int* p : priority) {
+        if (sq->items & p[0]) score += p[1];
+    }
+    return score;
+}
+
+static void site_row_update(int y) {
+    for (int s = 0; s < 2; s++) {
+        int* values = &site_values[s][y*site_row_len];
+        int* prefix = &site_prefix[s][y*(site_row_len + 1)];
+        prefix[0] = 0;
+        for (int k = 0; k < site_row_len; k++) {
+            prefix[k + 1] = prefix[k] + values[k];
+        }
+    }
+}
+
+static bool site_tile_update(int x, int y, int faction_id, bool full) {
+    int k = (x + *MapAreaX * y)/2;
+    uint64_t state = site_tile_state(&((*MapTiles)[k]));
+    if (full || site_state[k] != state) {
+        site_state[k] = state;
+        site_values[0][k] = site_tile_value(x, y, faction_id, false);
+        site_values[1][k] = site_tile_value(x, y, faction_id, true);
+        return true;
+    }
+    return false;
+}
+
+static void site_sync(int faction_id) {
+    if (site_faction != faction_id) {
+        site_faction = faction_id;
+        site_row_len = *MapAreaX/2;
+        site_journal.clear();
+        for (int s = 0; s < 2; s++) {
+            site_values[s].assign(site_row_len * *MapAreaY, 0);
+            site_prefix[s].assign((site_row_len + 1) * *MapAreaY, 0);
+        }
+        site_state.assign(*MapAreaTiles, 0);
+        for (int y = 0; y < *MapAreaY; y++) {
+            for (int x = y&1; x < *MapAreaX; x += 2) {
+                site_tile_update(x, y, faction_id, true);
+            }
+            site_row_update(y);
+        }
+        return;
+    }
+    if (site_journal.empty()) {
+        return;
+    }
+    // Territory can change up to territory_max_dist_base from the base tile
+    int updates = 0;
+    std::vector<bool> rows(*MapAreaY, false);
+    for (const auto& e : site_journal) {
+        int range = (e.type == UE_BaseChange
+            ? 2*(Rules->territory_max_dist_base + 1) : SiteTerrainRange);
+        for (int y = max(0, e.y - range); y <= min(*MapAreaY - 1, e.y + range); y++) {
+            for (int dx = -range; dx <= range; dx++) {
+                int x = (map_is_flat() ? e.x + dx : wrap(e.x + dx));
+                if (x >= 0 && x < *MapAreaX && !((x ^ y) & 1)
+                && site_tile_update(x, y, faction_id, false)) {
+                    rows[y] = true;
+                    updates++;
+                }
+            }
+        }
+    }
+    for (int y = 0; y < *MapAreaY; y++) {
+        if (rows[y]) {
+            site_row_update(y);
+        }
+    }
+    debug_ver("site_sync %d events: %d updates: %d\n",
+        faction_id, (int)site_journal.size(), updates);
+    site_journal.clear();
+}
+
+static int site_row_sum(int s, int y, int x1, int x2) {
+    const int* prefix = &site_prefix[s][y*(site_row_len + 1)];
+    int k1 = (x1 - (y&1))/2;
+    int k2 = (x2 - (y&1))/2;
+    if (map_is_flat()) {
+        k1 = max(k1, 0);
+        k2 = min(k2, site_row_len - 1);
+        return (k1 <= k2 ? prefix[k2 + 1] - prefix[k1] : 0);
+    }
+    if (k1 < 0) {
+        return prefix[site_row_len] - prefix[k1 + site_row_len] + prefix[k2 + 1];
+    }
+    if (k2 >= site_row_len) {
+        return prefix[site_row_len] - prefix[k1] + prefix[k2 - site_row_len + 1];
+    }
+    return prefix[k2 + 1] - prefix[k1];
+}
+
+/*
+Equivalent to base_tile_score but reads the radius sum from the site score rows.
+The adjacent tiles and tile ownership are still checked when the score is requested.
+*/
+static int site_score(int x, int y, int faction_id, MAP* sq) {
+    bool sea_colony = is_ocean(sq);
+    int s = sea_colony;
+    int score = min(min(y, *MapAreaY - y), min(*MapAreaY/4, 24)) / 2;
+    int land = 0;
+    score += (sq->items & BIT_SENSOR ? 8 : 0);
+    if (!sea_colony) {
+        score += (ocean_coast_tiles(x, y) ? 12 : 0);
+        score += (sq->items & BIT_RIVER ? 6 : 0);
+    }
+    for (int i = 0; i < 7; i++) {
+        int y2 = y + i - 3;
+        if (y2 >= 0 && y2 < *MapAreaY) {
+            score += site_row_sum(s, y2, x - SiteRowSpan[i], x + SiteRowSpan[i]);
+        }
+    }
+    if (!sq->is_base()) {
+        int bn = bonus_at(x, y);
+        int lm = sq->lm_items();
+        score -= site_values[s][(x + *MapAreaX * y)/2];
+        if (lm & ~(LM_DUNES|LM_SARGASSO|LM_UNITY)) {
+            score += (lm & LM_JUNGLE ? 3 : 2);
+        }
+        score += (bn ? (bn != RES_ENERGY ? 4 : 3) : 0);
+    }
+    for (int i = 1; i < 9; i++) {
+        MAP* sq2 = mapsq(wrap(x + TableOffsetX[i]), y + TableOffsetY[i]);
+        if (!sq2 || sq2->is_base()) {
+            continue;
+        }
+        int alt = sq2->alt_level();
+        if (sea_colony && sq2->is_land_region()
+        && Continents[sq2->region].tile_count >= 20
+        && (!sq2->is_owned() || sq2->owner == faction_id) && ++land < 3) {
+            score += (!sq2->is_owned() ? 20 : 4);
+        }
+        if (alt == ALT_OCEAN_SHELF) {
+            score += (sea_colony ? 3 : 2);
+        }
+        if (alt <= ALT_OCEAN) {
+            score -= (alt < ALT_OCEAN ? 8 : 4);
+        }
+    }
+    score += min(0, mapdata[{x, y}].safety);
+    shadow_check(SC_SiteScore, score, base_tile_score(x, y, faction_id, sq),
+        "%d %d faction: %d", x, y, faction_id);
+    return score;
+}
+
+/*
+Convoy candidates for supply crawlers. Tiles with convoying crawlers are counted
+once in convoy_units instead of scanning all vehicles for each tile. Each home
+base gets a ranked heap of target tiles scored by want_convoy on the first request
+after move_upkeep, and crawlers claim targets by popping the best entries.
+*/
+static const int ConvoyTargetRange = 8;
+static const int ConvoyTargetPops = 16;
+static int convoy_faction = -1;
+static std::unordered_map<Point, int> convoy_units;
+static std::map<int, point_max_queue_t> convoy_targets;
+
+static void convoy_reset() {
+    convoy_faction = -1;
+    convoy_units.clear();
+    convoy_targets.clear();
+}
+
+static void convoy_sync(int faction_id) {
+    if (convoy_faction != faction_id) {
+        convoy_reset();
+        convoy_faction = faction_id;
+        for (int i = *VehCount - 1; i >= 0; --i) {
+            if (Vehs[i].is_supply() && Vehs[i].order == ORDER_CONVOY) {
+                convoy_units[{Vehs[i].x, Vehs[i].y}]++;
+            }
+        }
+    }
+}
+
+static int convoy_count(int veh_id, int x, int y) {
+    VEH* veh = &Vehs[veh_id];
+    auto it = convoy_units.find({x, y});
+    int count = (it != convoy_units.end() ? it->second : 0);
+    if (veh->x == x && veh->y == y && veh->order == ORDER_CONVOY) {
+        count--;
+    }
+    return count;
+}
+
+/*
+Per-turn transport planner. Waiting land units are bucketed by their pickup tile
+(NODE_NEED_FERRY and NODE_NAVAL_START) and a sea distance field is searched once
+from each pickup. Empty transports are then assigned to pickups in order of
+increasing distance until the waiting units at each pickup are covered.
+trans_stacks keeps one vehicle per tile to find tile stacks without scanning Vehs.
+*/
+struct TransJob {
+    int x;
+    int y;
+    int tx;
+    int ty;
+};
+
+struct TransPair {
+    int dist;
+    int veh_id;
+    int x;
+    int y;
+
+    bool operator>(TransPair const& obj) const {
+        return dist > obj.dist || (dist == obj.dist && (veh_id > obj.veh_id
+            || (veh_id == obj.veh_id && (x > obj.x || (x == obj.x && y > obj.y)))));
+    }
+};
+
+static const int TransPlanRange = 16;
+static int trans_plan_faction = -1;
+static std::unordered_map<Point, int> trans_stacks;
+static std::unordered_map<int, TransJob> trans_jobs;
+
+static void trans_plan_reset() {
+    trans_plan_faction = -1;
+    trans_stacks.clear();
+    trans_jobs.clear();
+}
+
+/*
+Return the top vehicle on the tile using the stack index, or veh_at if the index is outdated.
+*/
+static int trans_stack_at(int x, int y) {
+    MAP* sq = mapsq(x, y);
+    if (!sq || !sq->veh_in_tile()) {
+        return -1;
+    }
+    auto it = trans_stacks.find({x, y});
+    if (it != trans_stacks.end() && it->second < *VehCount
+    && Vehs[it->second].x == x && Vehs[it->second].y == y) {
+        return veh_top(it->second);
+    }
+    return veh_at(x, y);
+}
+
+static void trans_plan(int faction_id) {
+    trans_plan_reset();
+    trans_plan_faction = faction_id;
+    std::unordered_map<Point, std::vector<int>> transports;
+    std::unordered_map<int, int> loaded;
+    for (int i = 0; i < *VehCount; i++) {
+        VEH* veh = &Vehs[i];
+        int k = veh->waypoint_x[0];
+        trans_stacks[{veh->x, veh->y}] = i;
+        if (veh->order == ORDER_SENTRY_BOARD && k >= 0 && k < *VehCount
+        && veh->x == Vehs[k].x && veh->y == Vehs[k].y) {
+            loaded[k]++;
+        }
+    }
+    for (int i = 0; i < *VehCount; i++) {
+        VEH* veh = &Vehs[i];
+        if (veh->faction_id == faction_id && veh->is_transport() && veh->triad() == TRIAD_SEA
+        && !veh->plr_owner() && veh->at_target() && !veh->need_heals() && !loaded.count(i)) {
+            transports[{veh->x, veh->y}].push_back(i);
+        }
+    }
+    if (transports.empty()) {
+        return;
+    }
+    std::map<Point, int> demand;
+    for (const MapNode& node : mapnodes) {
+        if (node.type != NODE_NEED_FERRY && node.type != NODE_NAVAL_START) {
+            continue;
+        }
+        int num = 0;
+        for (int k = trans_stack_at(node.x, node.y); k >= 0; k = Vehs[k].next_veh_id_stack) {
+            VEH* veh = &Vehs[k];
+            if (veh->faction_id == faction_id && veh->triad() == TRIAD_LAND
+            && veh->order != ORDER_SENTRY_BOARD
+            && (node.type == NODE_NEED_FERRY || veh->is_combat_unit() || veh->is_probe())) {
+                num++;
+            }
+            if (veh->faction_id == faction_id && veh->is_transport()) {
+                num -= veh_cargo(k) - (loaded.count(k) ? loaded[k] : 0);
+            }
+        }
+        if (num > 0) {
+            demand[{node.x, node.y}] = max(demand[{node.x, node.y}], num);
+        }
+    }
+    std::priority_queue<TransPair, arena_vector<TransPair>, std::greater<TransPair>> pairs;
+    TileSearch ts;
+    for (auto& d : demand) {
+        ts.init(d.first.x, d.first.y, TS_SEA_AND_SHORE);
+        while (ts.get_next() != NULL && ts.dist <= TransPlanRange) {
+            auto it = transports.find({ts.rx, ts.ry});
+            if (it != transports.end()) {
+                for (int veh_id : it->second) {
+                    pairs.push({ts.dist, veh_id, d.first.x, d.first.y});
+                }
+            }
+        }
+    }
+    while (!pairs.empty()) {
+        TransPair pair = pairs.top();
+        pairs.pop();
+        int& num = demand[{pair.x, pair.y}];
+        if (num <= 0 || trans_jobs.count(pair.veh_id)) {
+            continue;
+        }
+        VEH* veh = &Vehs[pair.veh_id];
+        num -= veh_cargo(pair.veh_id);
+        trans_jobs[pair.veh_id] = {veh->x, veh->y, pair.x, pair.y};
+        debug_ver("trans_plan %2d %2d -> %2d %2d dist: %d %s\n",
+            veh->x, veh->y, pair.x, pair.y, pair.dist, veh->name());
+    }
+    debug("trans_plan %d pickups: %d jobs: %d\n",
+        faction_id, (int)demand.size(), (int)trans_jobs.size());
+}
+
+/*
+Return the planned pickup tile for the empty transport if it still needs a ferry.
+*/
+static bool trans_plan_job(int veh_id, int* tx, int* ty) {
+    VEH* veh = &Vehs[veh_id];
+    auto it = trans_jobs.find(veh_id);
+    if (it == trans_jobs.end() || it->second.x != veh->x || it->second.y != veh->y) {
+        return false;
+    }
+    TransJob job = it->second;
+    trans_jobs.erase(it);
+    if (!mapnodes.count({job.tx, job.ty, NODE_NEED_FERRY})
+    && !mapnodes.count({job.tx, job.ty, NODE_NAVAL_START})) {
+        return false;
+    }
+    *tx = job.tx;
+    *ty = job.ty;
+    return true;
+}
+
+/*
+Add the safety, former and region values for the base used by move_upkeep,
+and record the tile values so that they can be replaced by upkeep_base_patch.
+*/
+static void upkeep_base_add(int faction_id, int base_id, MAP* sq) {
+    BASE* base = &Bases[base_id];
+    if (base->faction_id == faction_id) {
+        adjust_former(base->x, base->y, 2, base->pop_size);
+        mapdata[{base->x, base->y}].safety += 10000;
+        upkeep_bases[{base->x, base->y}] = {10000, base->pop_size};
+    } else if (has_pact(faction_id, base->faction_id) && !at_war(faction_id, base->faction_id)) {
+        mapdata[{base->x, base->y}].safety += 5000;
+        upkeep_bases[{base->x, base->y}] = {5000, 0};
+    }
+    if (base->faction_id != faction_id) {
+        if (at_war(faction_id, base->faction_id)) {
+            region_enemy.insert(sq->region);
+        }
+        if (allow_probe(faction_id, base->faction_id, true)) {
+            region_probe.insert(sq->region);
+        }
+    }
+}
+
+/*
+Replace the recorded base values on the tile with the values for the current base.
+Tiles next to a new own base are marked as near own base, but the flags are kept
+when a base is lost, since other bases may also be adjacent.
+*/
+static void upkeep_base_patch(int faction_id, int x, int y) {
+    MAP* sq = mapsq(x, y);
+    auto it = upkeep_bases.find({x, y});
+    if (it != upkeep_bases.end()) {
+        mapdata[{x, y}].safety -= it->second.safety;
+        if (it->second.former) {
+            adjust_former(x, y, 2, -it->second.former);
+        }
+        upkeep_bases.erase(it);
+    }
+    int base_id = base_at(x, y);
+    if (!sq || base_id < 0) {
+        return;
+    }
+    upkeep_base_add(faction_id, base_id, sq);
+    if (Bases[base_id].faction_id == faction_id && !is_ocean(sq)) {
+        for (auto& m : iterate_tiles(x, y, 1, 9)) {
+            if (m.sq->owner == faction_id && !is_ocean(m.sq)) {
+                mapdata[{m.x, m.y}].flags |= PM_NearOwnBase;
+            }
+        }
+    }
+}
+
+/*
+Update the shore values when the tile changed between land and ocean.
+*/
+static void upkeep_terrain_patch(int x, int y) {
+    MAP* sq = mapsq(x, y);
+    int k = (x + *MapAreaX * y)/2;
+    if (sq && k < (int)upkeep_ocean.size() && upkeep_ocean[k] != is_ocean(sq)) {
+        upkeep_ocean[k] = is_ocean(sq);
+        adjust_shore(x, y, 1, (upkeep_ocean[k] ? 1 : -1));
+    }
+}
+
+/*
+Refresh the priority maps between unit moves of the same faction turn.
+A full move_upkeep is done only on the first call for each faction turn.
+Later calls apply the journaled base and terrain events as local patches,
+and move the influence deposits (safety, unit_near, enemy_near, enemy) of
+the units journaled on earlier calls when they have moved since then.
+The current unit is journaled on its tile for the next call. Units moved
+manually between calls are not journaled and are updated on the next turn.
+*/
+void move_upkeep_refresh(int veh_id) {
+    VEH* veh = &Vehs[veh_id];
+    int faction_id = veh->faction_id;
+    if (move_upkeep_faction != faction_id || move_upkeep_turn != *CurrentTurn) {
+        move_upkeep(faction_id, UM_Player);
+        upkeep_moves.push_back({veh_id, veh->x, veh->y, veh->unit_id, faction_id});
+        return;
+    }
+    int events = upkeep_journal.size();
+    int moves = 0;
+    for (const auto& e : upkeep_journal) {
+        if (e.type == UE_BaseChange) {
+            upkeep_base_patch(faction_id, e.x, e.y);
+        } else if (e.type == UE_TerrainChange) {
+            upkeep_terrain_patch(e.x, e.y);
+        }
+    }
+    upkeep_journal.clear();
+    std::vector<InfluenceItem> diff;
+    for (const auto& m : upkeep_moves) {
+        VEH* cur = &Vehs[m.veh_id];
+        if (m.veh_id < *VehCount && cur->unit_id == m.unit_id && cur->faction_id == m.faction_id
+        && (cur->x != m.x || cur->y != m.y)) {
+            upkeep_move_items(diff, m, -1);
+            if (mapsq(cur->x, cur->y)) {
+                influence_veh(diff, faction_id, cur);
+            }
+            moves++;
+        }
+    }
+    upkeep_moves.clear();
+    upkeep_moves.push_back({veh_id, veh->x, veh->y, veh->unit_id, faction_id});
+    if (!diff.empty()) {
+        influence_flush(mapdata, diff, false);
+    }
+    if (events || moves) {
+        debug("move_upkeep_refresh %d %d events: %d moves: %d\n",
+            *CurrentTurn, faction_id, events, moves);
+    }
+}
+
 void move_upkeep(int faction_id, UpdateMode mode) {
     int tile_count[MaxRegionNum] = {};
     Faction& f = Factions[faction_id];
@@ -812,14 +1916,27 @@ void move_upkeep(int faction_id, UpdateMode mode) {
         return;
     }
     move_upkeep_faction = faction_id;
+    combat_cache_reset();
     update_main_region(faction_id);
     if (mode == UM_Player) {
         plans_upkeep(faction_id);
     }
-    mapdata.clear();
-    mapnodes.clear();
-    region_enemy.clear();
-    region_probe.clear();
+    mapdata = PMTable();
+    mapnodes = NodeSet();
+    region_enemy = arena_set<int>();
+    region_probe = arena_set<int>();
+    arena_reset();
+    mapdata.reserve(*MapAreaTiles);
+    former_plan_reset();
+    site_reset();
+    convoy_reset();
+    trans_plan_reset();
+    air_refuel_reset();
+    upkeep_journal.clear();
+    upkeep_moves.clear();
+    upkeep_bases.clear();
+    upkeep_ocean.assign(*MapAreaTiles, 0);
+    move_upkeep_turn = *CurrentTurn;
     debug("move_upkeep %d region: %d x: %2d y: %2d naval: %d\n",
         faction_id, p.main_region, p.main_region_x, p.main_region_y, p.prioritize_naval);
 
@@ -829,6 +1946,7 @@ void move_upkeep(int faction_id, UpdateMode mode) {
             if (!(sq = mapsq(x, y))) {
                 continue;
             }
+            upkeep_ocean[(x + *MapAreaX * y)/2] = is_ocean(sq);
             if (sq->region < MaxRegionNum) {
                 tile_count[sq->region]++;
                 if (is_ocean(sq)) {
@@ -857,14 +1975,19 @@ void move_upkeep(int faction_id, UpdateMode mode) {
             if ((sq = mapsq(x, y)) && sq->region == p.main_sea_region) {
                 adjust_shore(x, y, 1, PM_ShoreLine);
             }
-            assert(goody_at(x, y) == mod_goody_at(x, y));
-            assert(bonus_at(x, y) == mod_bonus_at(x, y));
-            assert(zoc_any(x, y, faction_id) == mod_zoc_any(x, y, faction_id));
-            assert(zoc_sea(x, y, faction_id) == mod_zoc_sea(x, y, faction_id));
-            assert(zoc_veh(x, y, faction_id) == mod_zoc_veh(x, y, faction_id));
-            assert(zoc_move(x, y, faction_id) == mod_zoc_move(x, y, faction_id));
-        }
-    }
+            shadow_check(SC_GoodyAt, mod_goody_at(x, y), goody_at(x, y), "%d %d", x, y);
+            shadow_check(SC_BonusAt, mod_bonus_at(x, y), bonus_at(x, y), "%d %d", x, y);
+            shadow_check(SC_ZocAny, mod_zoc_any(x, y, faction_id), zoc_any(x, y, faction_id),
+                "%d %d faction: %d", x, y, faction_id);
+            shadow_check(SC_ZocSea, mod_zoc_sea(x, y, faction_id), zoc_sea(x, y, faction_id),
+                "%d %d faction: %d", x, y, faction_id);
+            shadow_check(SC_ZocVeh, mod_zoc_veh(x, y, faction_id), zoc_veh(x, y, faction_id),
+                "%d %d faction: %d", x, y, faction_id);
+            shadow_check(SC_ZocMove, mod_zoc_move(x, y, faction_id), zoc_move(x, y, faction_id),
+                "%d %d faction: %d", x, y, faction_id);
+        }
+    }
+    std::vector<InfluenceItem> items;
     for (int i = 0, cnt = *VehCount; i < cnt; ++i) {
         VEH* veh = &Vehs[i];
         int triad = veh->triad();
@@ -881,11 +2004,8 @@ void move_upkeep(int faction_id, UpdateMode mode) {
         if (veh->order == ORDER_SENSOR_ARRAY) {
             mapnodes.insert({veh->x, veh->y, NODE_SENSOR_ARRAY});
         }
+        influence_veh(items, faction_id, veh);
         if (veh->faction_id == faction_id) {
-            if (veh->is_combat_unit()) {
-                adjust_safety(veh->x, veh->y, 1, 40);
-                mapdata[{veh->x, veh->y}].safety += 60;
-            }
             if (triad == TRIAD_LAND && (veh->is_colony() || veh->is_former() || veh->is_supply())) {
                 if (is_ocean(sq) && sq->is_base() && coast_tiles(veh->x, veh->y) < 8) {
                     mapnodes.insert({veh->x, veh->y, NODE_NEED_FERRY});
@@ -894,23 +2014,6 @@ void move_upkeep(int faction_id, UpdateMode mode) {
             if (veh->order >= ORDER_MOVE_TO && veh->waypoint_x[0] >= 0) {
                 mapnodes.erase({veh->waypoint_x[0], veh->waypoint_y[0], NODE_PATROL});
             }
-            adjust_unit_near(veh->x, veh->y, 3, (triad != TRIAD_AIR ? 2 : 1));
-
-        } else if (at_war(faction_id, veh->faction_id)) {
-            int value = (veh->is_combat_unit() ? -100 : (veh->is_probe() ? -24 : -12));
-            int range = (veh->speed() > 1 ? 3 : 2) + (triad == TRIAD_AIR ? 2 : 0);
-            if (value == -100) {
-                adjust_safety(veh->x, veh->y, range, value/(range > 2 ? 4 : 8));
-            }
-            mapdata[{veh->x, veh->y}].enemy++;
-            adjust_safety(veh->x, veh->y, 1, value);
-            if (veh->unit_id != BSC_FUNGAL_TOWER) {
-                adjust_enemy_near(veh->x, veh->y, 3, 1);
-            }
-
-        } else if (has_pact(faction_id, veh->faction_id) && veh->is_combat_unit()) {
-            adjust_safety(veh->x, veh->y, 1, 20);
-            mapdata[{veh->x, veh->y}].safety += 30;
         }
         // Check if we can evict neutral probe teams from home territory
         // Also check if we can capture artifacts from neutral or home territory
@@ -928,6 +2031,11 @@ void move_upkeep(int faction_id, UpdateMode mode) {
             }
         }
     }
+    if (DEBUG && shadow_sample(SC_Influence)) {
+        influence_check(items);
+    }
+    influence_flush(mapdata, items, true);
+
     TileSearch ts;
     PointList main_bases;
     PointList enemy_bases;
@@ -937,10 +2045,8 @@ void move_upkeep(int faction_id, UpdateMode mode) {
         if (!(sq = mapsq(base->x, base->y))) {
             continue;
         }
+        upkeep_base_add(faction_id, i, sq);
         if (base->faction_id == faction_id) {
-            adjust_former(base->x, base->y, 2, base->pop_size);
-            mapdata[{base->x, base->y}].safety += 10000;
-
             if (has_fac_built(FAC_PSI_GATE, i)) {
                 mapdata[{base->x, base->y}].flags |= PM_PsiGateBase;
             }
@@ -970,19 +2076,11 @@ void move_upkeep(int faction_id, UpdateMode mode) {
                     }
                 }
             }
-        } else {
-            if (at_war(faction_id, base->faction_id)) {
-                if (!is_ocean(sq)) {
-                    enemy_bases.push_back({base->x, base->y});
-                }
-                region_enemy.insert(sq->region);
-                enemy = true;
-            } else if (has_pact(faction_id, base->faction_id)) {
-                mapdata[{base->x, base->y}].safety += 5000;
-            }
-            if (allow_probe(faction_id, base->faction_id, true)) {
-                region_probe.insert(sq->region);
+        } else if (at_war(faction_id, base->faction_id)) {
+            if (!is_ocean(sq)) {
+                enemy_bases.push_back({base->x, base->y});
             }
+            enemy = true;
         }
     }
     if (f.base_count > 0 && enemy) {
@@ -1157,12 +2255,10 @@ ResType want_convoy(int veh_id, int x, int y, int* score, MAP* sq) {
 
     if (!sq->is_base() && base_id >= 0
     && (sq->owner == veh->faction_id || !sq->is_owned())) {
-        for (int i = *VehCount - 1; i >= 0; --i) {
-            if (veh_id != i && Vehs[i].x == x && Vehs[i].y == y
-            && Vehs[i].is_supply() && Vehs[i].order == ORDER_CONVOY) {
-                mapnodes.insert({x, y, NODE_CONVOY_SITE});
-                return RES_NONE;
-            }
+        convoy_sync(veh->faction_id);
+        if (convoy_count(veh_id, x, y) > 0) {
+            mapnodes.insert({x, y, NODE_CONVOY_SITE});
+            return RES_NONE;
         }
         int N = mod_crop_yield(veh->faction_id, base_id, x, y, 0);
         int M = mod_mine_yield(veh->faction_id, base_id, x, y, 0);
@@ -1204,6 +2300,67 @@ ResType want_convoy(int veh_id, int x, int y, int* score, MAP* sq) {
     return choice;
 }
 
+/*
+Pop the best convoy target for the crawler from the home base heap. Targets are ranked
+by want_convoy score and the crawler picks the best score minus distance among the
+top entries. Claimed tiles are removed and entries on other regions are kept for later.
+*/
+static bool convoy_target(int veh_id, int best_score, int* tx, int* ty) {
+    VEH* veh = &Vehs[veh_id];
+    int base_id = veh->home_base_id;
+    int region = region_at(veh->x, veh->y);
+    bool air = veh->triad() == TRIAD_AIR;
+    convoy_sync(veh->faction_id);
+    if (!convoy_targets.count(base_id)) {
+        point_max_queue_t& targets = convoy_targets[base_id];
+        BASE* base = &Bases[base_id];
+        int score;
+        for (auto& m : iterate_tiles(base->x, base->y, 0, TableRange[ConvoyTargetRange])) {
+            if (mapdata[{m.x, m.y}].safety >= PM_SAFE
+            && !non_ally_in_tile(m.x, m.y, veh->faction_id)
+            && want_convoy(veh_id, m.x, m.y, &score, m.sq) != RES_NONE) {
+                targets.push({m.x, m.y, score});
+            }
+        }
+        debug("convoy_targets %d %s\n", (int)targets.size(), base->name);
+    }
+    point_max_queue_t& targets = convoy_targets[base_id];
+    std::vector<MItem> skipped;
+    *tx = -1;
+    *ty = -1;
+    for (int i = 0; i < ConvoyTargetPops && !targets.empty(); i++) {
+        MItem item = targets.top();
+        targets.pop();
+        if (mapnodes.count({item.x, item.y, NODE_CONVOY_SITE})
+        || convoy_count(veh_id, item.x, item.y) > 0) {
+            continue; // Already claimed by another crawler
+        }
+        skipped.push_back(item);
+        if (item.score <= best_score) {
+            break;
+        }
+        if (!air && region_at(item.x, item.y) != region) {
+            continue;
+        }
+        int value = item.score - map_range(veh->x, veh->y, item.x, item.y);
+        if (value > best_score) {
+            best_score = value;
+            *tx = item.x;
+            *ty = item.y;
+        }
+    }
+    for (auto& item : skipped) {
+        if (item.x != *tx || item.y != *ty) {
+            targets.push(item);
+        }
+    }
+    if (*tx >= 0) {
+        debug("crawl_score %2d %2d score: %2d %s\n",
+            *tx, *ty, best_score, Bases[base_id].name);
+    }
+    return *tx >= 0;
+}
+
 int crawler_move(const int id) {
     VEH* veh = &Vehs[id];
     MAP* sq = mapsq(veh->x, veh->y);
@@ -1224,6 +2381,9 @@ int crawler_move(const int id) {
     if (!veh->at_target()) {
         // Move status overrides any waypoint target when the unit is not at target
         if (veh->order == ORDER_CONVOY) {
+            if (convoy_faction == veh->faction_id) {
+                convoy_units[{veh->x, veh->y}]--;
+            }
             veh->order = ORDER_MOVE_TO;
         }
         return VEH_SYNC;
@@ -1232,37 +2392,25 @@ int crawler_move(const int id) {
     ResType best_choice = want_convoy(id, veh->x, veh->y, &best_score, sq);
     if (best_choice != RES_NONE && (*CurrentTurn + id) % 4) {
         mapnodes.insert({veh->x, veh->y, NODE_CONVOY_SITE});
+        if (veh->order != ORDER_CONVOY) {
+            convoy_units[{veh->x, veh->y}]++;
+        }
         return set_convoy(id, best_choice);
     }
-    int i = 0;
     int tx = -1;
     int ty = -1;
-    int score = 0;
-    int limit = (best_choice != RES_NONE ? 80 : 120);
-    TileSearch ts;
-    ts.init(veh->x, veh->y, veh->triad());
-
-    while (++i <= limit && (sq = ts.get_next()) != NULL) {
-        if (mapdata[{ts.rx, ts.ry}].safety < PM_SAFE
-        || non_ally_in_tile(ts.rx, ts.ry, veh->faction_id)
-        || mapnodes.count({ts.rx, ts.ry, NODE_CONVOY_SITE})) {
-            continue;
-        }
-        int choice = want_convoy(id, ts.rx, ts.ry, &score, sq);
-        if (choice != RES_NONE && score - ts.dist > best_score) {
-            best_score = score - ts.dist;
-            tx = ts.rx;
-            ty = ts.ry;
-            debug("crawl_score %2d %2d res: %2d score: %2d %s\n",
-                ts.rx, ts.ry, choice, best_score, Bases[veh->home_base_id].name);
+    if (convoy_target(id, best_score, &tx, &ty)) {
+        if (veh->order == ORDER_CONVOY) {
+            convoy_units[{veh->x, veh->y}]--;
         }
-    }
-    if (tx >= 0) {
         mapnodes.insert({tx, ty, NODE_CONVOY_SITE});
         return set_move_to(id, tx, ty);
     }
     if (best_choice != RES_NONE) {
         mapnodes.insert({veh->x, veh->y, NODE_CONVOY_SITE});
+        if (veh->order != ORDER_CONVOY) {
+            convoy_units[{veh->x, veh->y}]++;
+        }
         return set_convoy(id, best_choice);
     }
     if (!veh->plr_owner() && !random(4)) {
@@ -1447,6 +2595,7 @@ int colony_move(const int id) {
     } else {
         ts.init(veh->x, veh->y, triad, 1);
     }
+    site_sync(faction_id);
     while (++i <= 2000 && (sq = ts.get_next()) != NULL) {
         if (mapnodes.count({ts.rx, ts.ry, NODE_BASE_SITE})
         || !can_build_base(ts.rx, ts.ry, faction_id, triad)
@@ -1455,7 +2604,7 @@ int colony_move(const int id) {
         || (airdrop && !allow_airdrop(ts.rx, ts.ry, faction_id, true, sq))) {
             continue;
         }
-        int score = base_tile_score(ts.rx, ts.ry, faction_id, sq) - 2*ts.dist;
+        int score = site_score(ts.rx, ts.ry, faction_id, sq) - 2*ts.dist;
         if (score > best_score) {
             tx = ts.rx;
             ty = ts.ry;
@@ -2142,8 +3291,41 @@ int former_move(const int id) {
     TileSearch ts;
     ts.init(veh->x, veh->y, veh->triad());
 
-    while (++i <= limit && (sq = ts.get_next()) != NULL) {
+    bool planned = false;
+    if (mode == FM_Auto_Full) {
+        if (former_plan_faction != faction_id) {
+            former_plan(faction_id);
+        }
+        if (!veh->plr_owner() && former_plan_job(id, &tx, &ty, &item)) {
+            best_score = former_plan_score(former_tiles[{tx, ty}], tx, ty);
+            planned = true;
+        }
+    }
+    while (!planned && ++i <= limit && (sq = ts.get_next()) != NULL) {
         auto& mp = mapdata[{ts.rx, ts.ry}];
+        if (mode == FM_Auto_Full) {
+            // Scores for all valid candidate tiles are already in the shared grid
+            if (home_base_only && map_range(bx, by, ts.rx, ts.ry) > 2) {
+                continue;
+            }
+            auto it = former_tiles.find({ts.rx, ts.ry});
+            if (it == former_tiles.end()) {
+                continue;
+            }
+            score = former_plan_score(it->second, ts.rx, ts.ry) - map_range(bx, by, ts.rx, ts.ry)/2;
+            if (score > best_score) {
+                // Grid was built at turn start, tiles may have become unsafe or occupied since
+                if (!former_plan_tile(ts.rx, ts.ry, faction_id, sq, mp)) {
+                    former_tiles.erase(it);
+                    continue;
+                }
+                tx = ts.rx;
+                ty = ts.ry;
+                best_score = score;
+                item = it->second.item;
+            }
+            continue;
+        }
         if (sq->is_base()
         || (sq->owner != faction_id && mp.roads < 1)
         || (home_base_only && map_range(bx, by, ts.rx, ts.ry) > 2)
@@ -2152,13 +3334,8 @@ int former_move(const int id) {
         || non_ally_in_tile(ts.rx, ts.ry, faction_id)) {
             continue;
         }
-        if (mode == FM_Auto_Full) {
-            score = former_tile_score(ts.rx, ts.ry, faction_id, sq)
-                - map_range(bx, by, ts.rx, ts.ry)/2;
-        } else {
-            score = former_tile_score(ts.rx, ts.ry, faction_id, sq)
-                - 2*map_range(veh->x, veh->y, ts.rx, ts.ry);
-        }
+        score = former_tile_score(ts.rx, ts.ry, faction_id, sq)
+            - 2*map_range(veh->x, veh->y, ts.rx, ts.ry);
         if (score > best_score && (choice = select_item(ts.rx, ts.ry, faction_id, mode, sq)) >= 0) {
             tx = ts.rx;
             ty = ts.ry;
@@ -2166,6 +3343,12 @@ int former_move(const int id) {
             item = choice;
         }
     }
+    if (mode == FM_Auto_Full && !planned && tx >= 0
+    && (item = select_item(tx, ty, faction_id, mode, mapsq(tx, ty))) < 0) {
+        former_tiles.erase({tx, ty});
+        tx = -1;
+        ty = -1;
+    }
     if (tx >= 0) {
         mapdata[{tx, ty}].former -= 2;
         debug("former_move %2d %2d -> %2d %2d score: %d %s\n",
@@ -2453,21 +3636,25 @@ int trans_move(const int id) {
     int tx = -1;
     int ty = -1;
     TileSearch ts;
-
-    for (int i = 0, cnt = *VehCount; i < cnt; ++i) {
+    if (trans_plan_faction != veh->faction_id) {
+        trans_plan(veh->faction_id);
+    }
+    for (int i = trans_stack_at(veh->x, veh->y); i >= 0; i = Vehs[i].next_veh_id_stack) {
         VEH* v = &Vehs[i];
-        if (veh->faction_id == v->faction_id && v->triad() == TRIAD_LAND && i != id) {
-            if (veh->x == v->x && veh->y == v->y) {
-                if (v->order == ORDER_SENTRY_BOARD && v->waypoint_x[0] == id) {
-                    cargo++;
-                    if (v->is_artifact()) {
-                        artifact++;
-                    }
-                    if (at_base && !mapnodes.count({veh->x, veh->y, NODE_NAVAL_START})) {
-                        mod_veh_wake(i);
-                    }
-                }
-            } else if (map_range(veh->x, veh->y, v->x, v->y) == 1) {
+        if (veh->faction_id == v->faction_id && v->triad() == TRIAD_LAND && i != id
+        && v->order == ORDER_SENTRY_BOARD && v->waypoint_x[0] == id) {
+            cargo++;
+            if (v->is_artifact()) {
+                artifact++;
+            }
+            if (at_base && !mapnodes.count({veh->x, veh->y, NODE_NAVAL_START})) {
+                mod_veh_wake(i);
+            }
+        }
+    }
+    for (auto& m : iterate_tiles(veh->x, veh->y, 1, 9)) {
+        for (int i = trans_stack_at(m.x, m.y); i >= 0; i = Vehs[i].next_veh_id_stack) {
+            if (veh->faction_id == Vehs[i].faction_id && Vehs[i].triad() == TRIAD_LAND) {
                 nearby++;
             }
         }
@@ -2509,7 +3696,11 @@ int trans_move(const int id) {
     if (!at_base) {
         if (cargo > artifact && near_landing(id)) {
             bool landed = false;
-            for (int i = 0, cnt = *VehCount; i < cnt; ++i) {
+            std::vector<int> stack;
+            for (int i = trans_stack_at(veh->x, veh->y); i >= 0; i = Vehs[i].next_veh_id_stack) {
+                stack.push_back(i);
+            }
+            for (int i : stack) {
                 VEH* v = &Vehs[i];
                 if (veh->x == v->x && veh->y == v->y && i != id
                 && v->triad() == TRIAD_LAND && !v->is_artifact()
@@ -2532,7 +3723,7 @@ int trans_move(const int id) {
         }
     }
     if (at_base && mapnodes.count({veh->x, veh->y, NODE_NAVAL_START})) {
-        for (int i = 0, cnt = *VehCount; i < cnt; ++i) {
+        for (int i = trans_stack_at(veh->x, veh->y); i >= 0; i = Vehs[i].next_veh_id_stack) {
             if (cargo >= capacity) {
                 break;
             }
@@ -2565,6 +3756,10 @@ int trans_move(const int id) {
     && sq->region == region_at(p.naval_end_x, p.naval_end_y)) {
         max_dist = 4;
     }
+    if (!cargo && trans_plan_job(id, &tx, &ty)) {
+        debug("trans_ferry %2d %2d -> %2d %2d\n", veh->x, veh->y, tx, ty);
+        return set_move_to(id, tx, ty);
+    }
     ts.init(veh->x, veh->y, TS_SEA_AND_SHORE);
 
     while ((sq = ts.get_next()) != NULL && ts.dist <= max_dist) {
@@ -2916,6 +4111,7 @@ int combat_move(const int id) {
     const bool chopper = aircraft && !missile && unit_range == 1;
     const bool gravship = aircraft && !missile && unit_range == 0;
     const bool needlejet = aircraft && veh->chassis_type() == CHS_NEEDLEJET;
+    const bool fuel_limit = aircraft && air_fuel_range(id) >= 0;
     const bool teleport = at_base && veh_sq->owner == faction_id
         && mapdata[{veh->x, veh->y}].flags & PM_PsiGateBase;
     const bool hold_tile = needlejet && !refuel && max_range < 4
@@ -3061,6 +4257,9 @@ int combat_move(const int id) {
     while (aircraft && combat && (sq = ts.get_next()) != NULL && ts.dist <= max_dist) {
         int score;
         auto& mp = mapdata[{ts.rx, ts.ry}];
+        if (fuel_limit && !air_reachable(id, ts.rx, ts.ry)) {
+            continue;
+        }
         if ((id2 = choose_defender(ts.rx, ts.ry, id, sq)) >= 0) {
             VEH* veh2 = &Vehs[id2];
             if (!sq->is_base() && veh2->chassis_type() == CHS_NEEDLEJET
@@ -3,6 +3,7 @@
 #include "main.h"
 
 enum UpdateMode {UM_Full, UM_Visual, UM_Player};
+enum UpkeepEventType {UE_VehKill, UE_BaseChange, UE_TerrainChange};
 enum StackType {ST_NeutralOnly, ST_NonPactOnly, ST_EnemyOnly, ST_EnemyOneUnit};
 enum FormerMode {FM_Auto_Full, FM_Auto_Roads, FM_Auto_Tubes, FM_Auto_Sensors,
     FM_Remove_Fungus, FM_Farm_Road, FM_Mine_Road};
@@ -49,11 +50,16 @@ bool allow_airdrop(int x, int y, int faction_id, bool combat, MAP* sq);
 bool invasion_unit(int veh_id);
 bool near_landing(int veh_id);
 int make_landing(int veh_id);
+int air_refuel_dist(int faction_id, int x, int y);
+int air_fuel_range(int veh_id);
+bool air_reachable(int veh_id, int x, int y);
 
 int __cdecl mod_enemy_move(int veh_id);
 int __cdecl veh_kill_lift(int veh_id);
 void update_main_region(int faction_id);
 void move_upkeep(int faction_id, UpdateMode mode);
+void move_upkeep_refresh(int veh_id);
+void move_upkeep_event(UpkeepEventType type, int x, int y);
 int crawler_move(const int id);
 int colony_move(const int id);
 int former_move(const int id);
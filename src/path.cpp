@@ -294,14 +294,14 @@ int path_cost(int x1, int y1, int x2, int y2, int unit_id, int faction_id, int m
 
 int route_dist(PMTable& tbl, int x1, int y1, int x2, int y2) {
     Points visited;
-    std::list<PathNode> items;
+    std::vector<PathNode> items;
     items.push_back({x1, y1, 0, 0});
     int limit = max(8, map_range(x1, y1, x2, y2) * 2);
     int i = 0;
+    size_t head = 0;
 
-    while (items.size() > 0 && ++i <= PathLimit) {
-        PathNode cur = items.front();
-        items.pop_front();
+    while (head < items.size() && ++i <= PathLimit) {
+        PathNode cur = items[head++];
         if (cur.x == x2 && cur.y == y2 && cur.dist <= limit) {
             debug_ver("route_dist %2d %2d -> %2d %2d = %d %d\n", x1, y1, x2, y2, i, cur.dist);
             return cur.dist;
@@ -348,20 +348,25 @@ void update_move_path(PMTable& tbl, int veh_id, int tx, int ty) {
     }
 }
 
-std::vector<MapTile> iterate_tiles(int x, int y, size_t start_index, size_t end_index) {
-    std::vector<MapTile> tiles;
+TileRange::TileRange(int cx, int cy, size_t start, size_t end) :
+x(cx), y(cy), start_index(start), end_index(end) {
     assert(start_index < end_index && end_index <= (size_t)TableRange[MaxTableRange]);
+}
 
-    for (size_t i = start_index; i < end_index; i++) {
-        int x2 = wrap(x + TableOffsetX[i]);
-        int y2 = y + TableOffsetY[i];
+void TileRange::iterator::next() {
+    for (; index < range->end_index; index++) {
+        int x2 = wrap(range->x + TableOffsetX[index]);
+        int y2 = range->y + TableOffsetY[index];
         MAP* sq = mapsq(x2, y2);
         if (sq) {
-            tiles.push_back({x2, y2, (int)i, sq});
+            tile = {x2, y2, (int)index, sq};
+            return;
         }
     }
-    assert(tiles.size() > 0);
-    return tiles;
+}
+
+TileRange iterate_tiles(int x, int y, size_t start_index, size_t end_index) {
+    return TileRange(x, y, start_index, end_index);
 }
 
 int nearby_items(int x, int y, size_t start_index, size_t end_index, uint32_t item) {
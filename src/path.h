@@ -75,6 +75,32 @@ enum NodesetType {
     NODE_COMBAT_PATROL, // Only attack-capable units
 };
 
+/*
+Valid map tiles around the center in the order of TableOffsetX/Y. Each tile is
+resolved while iterating so that the range does not allocate any memory.
+*/
+class TileRange {
+    int x;
+    int y;
+    size_t start_index;
+    size_t end_index;
+    public:
+    class iterator {
+        const TileRange* range;
+        size_t index;
+        MapTile tile;
+        void next();
+        public:
+        iterator(const TileRange* r, size_t i) : range(r), index(i) { next(); }
+        MapTile& operator*() { return tile; }
+        iterator& operator++() { index++; next(); return *this; }
+        bool operator!=(const iterator& other) const { return index != other.index; }
+    };
+    TileRange(int cx, int cy, size_t start, size_t end);
+    iterator begin() const { return iterator(this, start_index); }
+    iterator end() const { return iterator(this, end_index); }
+};
+
 struct PathNode {
     int x;
     int y;
@@ -114,7 +140,7 @@ int show_path_cost(int x1, int y1, int x2, int y2, int unit_id, int faction_id);
 int path_cost(int x1, int y1, int x2, int y2, int unit_id, int faction_id, int max_cost);
 int route_dist(PMTable& tbl, int x1, int y1, int x2, int y2);
 void update_move_path(PMTable& tbl, int veh_id, int tx, int ty);
-std::vector<MapTile> iterate_tiles(int x, int y, size_t start_index, size_t end_index);
+TileRange iterate_tiles(int x, int y, size_t start_index, size_t end_index);
 int nearby_items(int x, int y, size_t start_index, size_t end_index, uint32_t item);
 bool defend_tile(VEH* veh, MAP* sq);
 bool safe_path(TileSearch& ts, int faction_id, bool skip_owner);
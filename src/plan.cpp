@@ -34,6 +34,9 @@ void reset_state() {
     // Invalidate all previous plans
     plan_upkeep_turn = -1;
     move_upkeep_faction = -1;
+    social_cache_reset();
+    tech_plan_reset();
+    combat_cache_reset();
 }
 
 static bool check_disband(int unit_id, int faction_id) {
@@ -116,7 +116,8 @@ int __cdecl mod_mind_control(int base_id, int faction_id, int is_corner_market)
     } else if (has_treaty(base->faction_id, faction_id, DIPLO_WANT_REVENGE)) {
         cost += cost / 2;
     }
-    assert(cost == mind_control(base_id, faction_id, is_corner_market));
+    shadow_check(SC_MindControl, cost, mind_control(base_id, faction_id, is_corner_market),
+        "base: %d faction: %d", base_id, faction_id);
     return cost;
 }
 
@@ -158,7 +159,8 @@ int __cdecl mod_success_rates(size_t index, int morale, int diff_modifier, int b
         snprintf(chances, 32, "%d%%, %d%%", success_rate, survival_rate);
     }
     parse_says(index, chances, -1, -1);
-    assert(success_rate == success_rates(index, morale, diff_modifier, base_id));
+    shadow_check(SC_SuccessRates, success_rate, success_rates(index, morale, diff_modifier, base_id),
+        "index: %d morale: %d base: %d", index, morale, base_id);
     return success_rate;
 }
 
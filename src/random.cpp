@@ -69,6 +69,33 @@ int32_t GameRandom::get(int32_t limit) {
     return ((state & 0xffff) * limit) >> 16;
 }
 
+static uint64_t splitmix64(uint64_t x) {
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+/*
+SplitMix64 style hash of the stream id, key and counter. The stream and key are
+mixed first so that the counters of different streams are not correlated.
+*/
+static uint64_t stream_hash(uint32_t stream, uint64_t key, uint32_t counter) {
+    uint64_t base = splitmix64(key ^ splitmix64(stream + 0x9E3779B97F4A7C15ull));
+    return splitmix64(base + (counter + 1ull) * 0x9E3779B97F4A7C15ull);
+}
+
+/*
+Counter-based random values in the range [0, limit) that only depend on the stream id,
+key and counter, unlike the shared sequential generators. The values are taken from
+the upper 32 bits of the hash.
+*/
+int32_t stream_get(uint32_t stream, uint64_t key, uint32_t counter, int32_t limit) {
+    if (limit <= 1) {
+        return 0;
+    }
+    return (int32_t)(((stream_hash(stream, key, counter) >> 32) * (uint64_t)limit) >> 32);
+}
+
 #ifdef BUILD_DEBUG
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wuseless-cast"
@@ -201,6 +228,51 @@ uint32_t hash32(const void* input, size_t len, uint64_t seed) {
     return h;
 }
 
+/*
+Statistical sanity check and throughput comparison for the random stream functions.
+Bucket counts are tested with chi-squared (63 degrees of freedom, p = 0.001 limit
+is 103.4) and each output bit must be set close to half of the time. Results are
+written to the debug log when the check is started from the developer shortcut.
+*/
+void random_check() {
+    const int Samples = 1 << 20;
+    const int Buckets = 64;
+    int counts[Buckets] = {};
+    int bits[32] = {};
+    for (int i = 0; i < Samples; i++) {
+        counts[stream_get(RS_Landmark, 12345, i, Buckets)]++;
+        uint32_t value = (uint32_t)stream_hash(RS_Landmark, 777, i);
+        for (int j = 0; j < 32; j++) {
+            bits[j] += (value >> j) & 1;
+        }
+    }
+    double chi = 0;
+    double expected = 1.0 * Samples / Buckets;
+    for (int i = 0; i < Buckets; i++) {
+        chi += (counts[i] - expected) * (counts[i] - expected) / expected;
+    }
+    int bit_errors = 0;
+    for (int j = 0; j < 32; j++) {
+        // Four standard deviations for a binomial with p = 0.5
+        bit_errors += fabs(bits[j] - Samples/2.0) > 4 * sqrt(Samples/4.0);
+    }
+    GameRandom lcg;
+    int32_t sum = 0;
+    uint32_t start = GetTickCount();
+    for (int i = 0; i < Samples * 4; i++) {
+        sum += lcg.get(100);
+    }
+    uint32_t lcg_time = GetTickCount() - start;
+    start = GetTickCount();
+    for (int i = 0; i < Samples * 4; i++) {
+        sum += stream_get(RS_Landmark, 1, i, 100);
+    }
+    uint32_t stream_time = GetTickCount() - start;
+    debug("random_check chi2: %.1f bit_errors: %d lcg_ms: %u stream_ms: %u draws: %d sum: %d\n",
+        chi, bit_errors, lcg_time, stream_time, Samples * 4, sum);
+    assert(chi < 103.4 && !bit_errors);
+}
+
 #pragma GCC diagnostic pop
 #endif
 
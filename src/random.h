@@ -10,6 +10,12 @@ uint32_t random_state();
 int32_t random(int32_t limit);
 int32_t random_get(int32_t low, int32_t high);
 
+enum RandomStreamId {
+    RS_Landmark = 2,
+};
+
+int32_t stream_get(uint32_t stream, uint64_t key, uint32_t counter, int32_t limit);
+
 class GameRandom {
     private:
     uint32_t state = 0;
@@ -38,5 +44,6 @@ const T& pick_random(const std::set<T>& s) {
 #ifdef BUILD_DEBUG
 uint64_t hash64(const void* input, size_t len, uint64_t seed);
 uint32_t hash32(const void* input, size_t len, uint64_t seed);
+void random_check();
 #endif
 
@@ -45,18 +45,89 @@ int __cdecl has_tech(int tech_id, int faction_id) {
 }
 
 /*
-Calculate technology level for tech_id. Replaces function tech_recurse.
+Prerequisite closure for all technologies, rebuilt by tech_preq_init after read_tech.
+TechPreqBits contains all direct and indirect prerequisites for each technology and
+TechPreqDepth stores the shortest distance to each of them in the prerequisite tree.
 */
-int __cdecl tech_level(int tech_id, int lvl) {
+static bool tech_preq_valid = false;
+static uint8_t TechLevels[MaxTechnologyNum];
+static uint8_t TechPreqDepth[MaxTechnologyNum][MaxTechnologyNum];
+static uint32_t TechPreqBits[MaxTechnologyNum][(MaxTechnologyNum + 31) / 32];
+
+static int tech_level_recurse(int tech_id, int lvl) {
     if (tech_id < 0 || tech_id > TECH_TranT || lvl > TECH_TranT) {
         return lvl;
     } else {
-        int v1 = tech_level(Tech[tech_id].preq_tech1, lvl + 1);
-        int v2 = tech_level(Tech[tech_id].preq_tech2, lvl + 1);
+        int v1 = tech_level_recurse(Tech[tech_id].preq_tech1, lvl + 1);
+        int v2 = tech_level_recurse(Tech[tech_id].preq_tech2, lvl + 1);
         return max(v1, v2);
     }
 }
 
+static int tech_is_preq_recurse(int preq_tech_id, int parent_tech_id, int range) {
+    if (preq_tech_id < 0 || parent_tech_id < 0) {
+        return false;
+    }
+    if (preq_tech_id == parent_tech_id) {
+        return true;
+    }
+    if (range <= 0) {
+        return false;
+    }
+    return tech_is_preq_recurse(preq_tech_id, Tech[parent_tech_id].preq_tech1, range - 1)
+        || tech_is_preq_recurse(preq_tech_id, Tech[parent_tech_id].preq_tech2, range - 1);
+}
+
+/*
+Calculate the prerequisite closure and tech levels once the technology tree is parsed.
+Each technology is searched breadth-first to find the shortest depth for every prerequisite.
+*/
+void tech_preq_init() {
+    int queue[MaxTechnologyNum];
+    memset(TechPreqDepth, 0xff, sizeof(TechPreqDepth));
+    memset(TechPreqBits, 0, sizeof(TechPreqBits));
+
+    for (int i = 0; i < MaxTechnologyNum; i++) {
+        int head = 0;
+        int tail = 0;
+        queue[tail++] = i;
+        TechPreqDepth[i][i] = 0;
+        TechPreqBits[i][i / 32] |= (1u << (i % 32));
+        while (head < tail) {
+            int tech_id = queue[head++];
+            int preqs[] = {Tech[tech_id].preq_tech1, Tech[tech_id].preq_tech2};
+            for (int preq : preqs) {
+                if (preq >= 0 && preq < MaxTechnologyNum && TechPreqDepth[i][preq] == 0xff) {
+                    TechPreqDepth[i][preq] = TechPreqDepth[i][tech_id] + 1;
+                    TechPreqBits[i][preq / 32] |= (1u << (preq % 32));
+                    queue[tail++] = preq;
+                }
+            }
+        }
+        TechLevels[i] = tech_level_recurse(i, 0);
+    }
+    tech_preq_valid = true;
+#ifdef BUILD_DEBUG
+    for (int i = 0; i < MaxTechnologyNum; i++) {
+        for (int j = 0; j < MaxTechnologyNum; j++) {
+            assert(tech_is_preq(j, i, 1) == tech_is_preq_recurse(j, i, 1));
+            assert(tech_is_preq(j, i, 3) == tech_is_preq_recurse(j, i, 3));
+            assert(tech_is_preq(j, i, 9999) == tech_is_preq_recurse(j, i, 9999));
+        }
+    }
+#endif
+}
+
+/*
+Calculate technology level for tech_id. Replaces function tech_recurse.
+*/
+int __cdecl tech_level(int tech_id, int lvl) {
+    if (lvl == 0 && tech_preq_valid && tech_id >= 0 && tech_id < MaxTechnologyNum) {
+        return TechLevels[tech_id];
+    }
+    return tech_level_recurse(tech_id, lvl);
+}
+
 /*
 Determine what category is the most important for tech_id.
 If there is a tie, the order of precedence is as follows: growth > tech > wealth > power.
@@ -81,16 +152,23 @@ int __cdecl tech_category(int tech_id) {
     return (tech.AI_power > value) ? TCAT_POWER : label;
 }
 
+/*
+Techs that are only available in SMACX mode.
+*/
+static bool tech_expansion_only(int tech_id) {
+    return tech_id == TECH_PrPsych || tech_id == TECH_FldMod || tech_id == TECH_AdapDoc
+        || tech_id == TECH_AdapEco || tech_id == TECH_Bioadap || tech_id == TECH_SentRes
+        || tech_id == TECH_SecMani || tech_id == TECH_NewMiss || tech_id == TECH_BFG9000;
+}
+
 /*
 Check to see whether provided faction can research a specific technology.
 Includes checks to prevent SMACX specific techs from being researched in SMAC mode.
 */
 int __cdecl mod_tech_avail(int tech_id, int faction_id) {
     assert(faction_id >= 0 && faction_id < MaxPlayerNum && tech_id >= 0);
-    if (has_tech(tech_id, faction_id) || tech_id >= MaxTechnologyNum || (!*ExpansionEnabled
-    && (tech_id == TECH_PrPsych || tech_id == TECH_FldMod || tech_id == TECH_AdapDoc
-    || tech_id == TECH_AdapEco || tech_id == TECH_Bioadap || tech_id == TECH_SentRes
-    || tech_id == TECH_SecMani || tech_id == TECH_NewMiss || tech_id == TECH_BFG9000))) {
+    if (has_tech(tech_id, faction_id) || tech_id >= MaxTechnologyNum
+    || (!*ExpansionEnabled && tech_expansion_only(tech_id))) {
         return false;
     }
     int preq_tech_1 = Tech[tech_id].preq_tech1;
@@ -107,6 +185,7 @@ Calculate the tech related bonuses for commerce and resource production in fungu
 void __cdecl mod_tech_effects(int faction_id) {
     Faction* f = &Factions[faction_id];
     MFaction* m = &MFactions[faction_id];
+    combat_cache_reset();
     f->tech_commerce_bonus = m->rule_commerce;
     f->tech_fungus_nutrient = 0;
     f->tech_fungus_mineral = 0;
@@ -639,8 +718,11 @@ int __cdecl tech_is_preq(int preq_tech_id, int parent_tech_id, int range) {
     if (range <= 0) {
         return false;
     }
-    return tech_is_preq(preq_tech_id, Tech[parent_tech_id].preq_tech1, range - 1)
-        || tech_is_preq(preq_tech_id, Tech[parent_tech_id].preq_tech2, range - 1);
+    if (tech_preq_valid && preq_tech_id < MaxTechnologyNum && parent_tech_id < MaxTechnologyNum) {
+        return (TechPreqBits[parent_tech_id][preq_tech_id / 32] & (1u << (preq_tech_id % 32)))
+            && TechPreqDepth[parent_tech_id][preq_tech_id] <= range;
+    }
+    return tech_is_preq_recurse(preq_tech_id, parent_tech_id, range);
 }
 
 /*
@@ -703,7 +785,8 @@ int __cdecl mod_tech_val(int tech_id, int faction_id, int simple_calc) {
             }
         }
         if (simple_calc) {
-            assert(value == tech_val(tech_id, faction_id, simple_calc));
+            shadow_check(SC_TechVal, value, tech_val(tech_id, faction_id, simple_calc),
+                "tech: %d faction: %d", tech_id, faction_id);
             return value;
         }
         if (base_count) {
@@ -859,7 +942,8 @@ int __cdecl mod_tech_val(int tech_id, int faction_id, int simple_calc) {
                 value = (value * 2) + 4;
             }
         }
-        assert(value == tech_val(tech_id, faction_id, simple_calc));
+        shadow_check(SC_TechVal, value, tech_val(tech_id, faction_id, simple_calc),
+            "tech: %d faction: %d", tech_id, faction_id);
         if (conf.tech_balance) {
             bool high_cost = revised_tech_cost() && tech_id_lvl > 2;
             if (tech_id == Weapon[WPN_TERRAFORMING_UNIT].preq_tech) {
@@ -884,14 +968,16 @@ int __cdecl mod_tech_val(int tech_id, int faction_id, int simple_calc) {
             factor++;
         }
         value = factor * (factor / (f->AI_fight + 2));
-        assert(value == tech_val(tech_id, faction_id, simple_calc));
+        shadow_check(SC_TechVal, value, tech_val(tech_id, faction_id, simple_calc),
+            "tech: %d faction: %d", tech_id, faction_id);
     } else {  // Prototypes
         UNIT* u = &Units[tech_id - 97];
         value = clamp(u->offense_value(), 1, 2)
             + clamp(u->defense_value(), 1, 2)
             + clamp((int)u->speed(), 1, 2)
             + u->reactor_id - 2;
-        assert(value == tech_val(tech_id, faction_id, simple_calc));
+        shadow_check(SC_TechVal, value, tech_val(tech_id, faction_id, simple_calc),
+            "tech: %d faction: %d", tech_id, faction_id);
     }
     return value;
 }
@@ -899,9 +985,14 @@ int __cdecl mod_tech_val(int tech_id, int faction_id, int simple_calc) {
 int __cdecl mod_tech_ai(int faction_id) {
     int tech_id = -1;
     int best_value = INT_MIN;
+    bool planned = faction_id > 0 && !is_human(faction_id) && thinker_enabled(faction_id)
+        && tech_plan_update(faction_id) >= 0;
     for (int i = 0; i < MaxTechnologyNum; i++) {
         if (mod_tech_avail(i, faction_id)) {
             int tech_value = mod_tech_val(i, faction_id, false);
+            if (planned && tech_plan_path(i, faction_id)) {
+                tech_value *= 2;
+            }
             debug("tech_val %d %d value: %3d tech: %2d %s\n",
             *CurrentTurn, faction_id, tech_value, i, Tech[i].name);
             if (*GameRules & RULES_BLIND_RESEARCH) {
@@ -923,7 +1014,7 @@ int __cdecl mod_tech_ai(int faction_id) {
     return tech_id;
 }
 
-int tech_cost(int tech_id, int faction_id) {
+static int tech_cost_calc(int tech_id, int faction_id, bool verbose) {
     assert(valid_player(faction_id));
     MFaction* m = &MFactions[faction_id];
     int level = 1;
@@ -956,14 +1047,220 @@ int tech_cost(int tech_id, int faction_id) {
         * (*GameRules & RULES_TECH_STAGNATION ? conf.tech_stagnate_rate / 100.0 : 1.0)
         * (1.0 - 0.05*min(6, owners));
 
-    debug("tech_cost %d %d base: %7.2f diff: %.2f cost: %7.2f "
-    "level: %d our_techs: %d owners: %d tech: %2d %s\n",
-    *CurrentTurn, faction_id, cost_base, cost_diff, cost,
-    level, our_techs, owners, tech_id, tech_str(tech_id));
+    if (verbose) {
+        debug("tech_cost %d %d base: %7.2f diff: %.2f cost: %7.2f "
+        "level: %d our_techs: %d owners: %d tech: %2d %s\n",
+        *CurrentTurn, faction_id, cost_base, cost_diff, cost,
+        level, our_techs, owners, tech_id, tech_str(tech_id));
+    }
 
     return clamp((int)cost, 1, 99999999);
 }
 
+int tech_cost(int tech_id, int faction_id) {
+    return tech_cost_calc(tech_id, faction_id, true);
+}
+
+/*
+Research planner for distant key technologies. The full prerequisite path for a target
+has to be researched anyway, so the minimum cost to reach it is the sum of costs
+for all prerequisites not yet owned. Plans are kept across turns and updated when
+the faction acquires new techs by any means, including trading and theft.
+*/
+const int TechWords = (MaxTechnologyNum + 31) / 32;
+const int TechPlanTurns = 10;
+
+struct TechPlan {
+    int target = -1;
+    int turn = -1;
+    int cost = 0;
+    uint32_t owned[TechWords] = {};
+    uint32_t path[TechWords] = {};
+    int costs[MaxTechnologyNum] = {};
+};
+
+static TechPlan tech_plans[MaxPlayerNum];
+
+static bool tech_disabled(int tech_id) {
+    return Tech[tech_id].preq_tech1 == TECH_Disable || Tech[tech_id].preq_tech2 == TECH_Disable
+        || (!*ExpansionEnabled && tech_expansion_only(tech_id));
+}
+
+static int tech_plan_weight(int tech_id, int faction_id) {
+    Faction* f = &Factions[faction_id];
+    int weight = 0;
+    for (int i = SP_ID_First; i <= SP_ID_Last; i++) {
+        if (Facility[i].preq_tech == tech_id && project_base((FacilityId)i) == SP_Unbuilt) {
+            weight += 2 + f->AI_tech + f->AI_wealth;
+        }
+    }
+    for (int i = 0; i < MaxChassisNum; i++) {
+        if (Chassis[i].preq_tech == tech_id) {
+            weight += 3 + f->AI_power + f->AI_growth;
+        }
+    }
+    for (int i = 0; i < MaxReactorNum; i++) {
+        if (Reactor[i].preq_tech == tech_id) {
+            weight += 4 + f->AI_power;
+        }
+    }
+    return weight;
+}
+
+void tech_plan_reset() {
+    for (int i = 0; i < MaxPlayerNum; i++) {
+        tech_plans[i].target = -1;
+        tech_plans[i].turn = -1;
+    }
+}
+
+static void tech_plan_owned(int faction_id, uint32_t* owned) {
+    memset(owned, 0, TechWords * sizeof(uint32_t));
+    for (int i = 0; i < MaxTechnologyNum; i++) {
+        if (has_tech(i, faction_id)) {
+            owned[i / 32] |= (1u << (i % 32));
+        }
+    }
+}
+
+/*
+Solve the minimum cost for every technology as a target and select the best key tech
+by value per research cost. The result replaces the current plan for the faction.
+Return Value: Number of target techs evaluated
+*/
+static int tech_plan_full(int faction_id, const uint32_t* owned, int* best_score) {
+    TechPlan& p = tech_plans[faction_id];
+    int targets = 0;
+    *best_score = 0;
+    p.target = -1;
+    p.turn = *CurrentTurn;
+    p.cost = 0;
+    memcpy(p.owned, owned, sizeof(p.owned));
+    memset(p.path, 0, sizeof(p.path));
+    for (int i = 0; i < MaxTechnologyNum; i++) {
+        p.costs[i] = (owned[i / 32] & (1u << (i % 32)) || tech_disabled(i)
+            ? 0 : tech_cost_calc(i, faction_id, false));
+    }
+    for (int i = 0; i < MaxTechnologyNum; i++) {
+        if (owned[i / 32] & (1u << (i % 32)) || tech_disabled(i)) {
+            continue;
+        }
+        int cost = 0;
+        int steps = 0;
+        bool valid = true;
+        targets++;
+        for (int w = 0; w < TechWords && valid; w++) {
+            uint32_t missing = TechPreqBits[i][w] & ~owned[w];
+            while (missing) {
+                int tech_id = 32*w + __builtin_ctz(missing);
+                missing &= missing - 1;
+                if (tech_disabled(tech_id)) {
+                    valid = false;
+                    break;
+                }
+                cost += p.costs[tech_id];
+                steps++;
+            }
+        }
+        int weight;
+        if (!valid || steps < 2 || !(weight = tech_plan_weight(i, faction_id))) {
+            continue;
+        }
+        int score = 1000 * weight * mod_tech_val(i, faction_id, true) / max(1, cost);
+        if (score > *best_score) {
+            *best_score = score;
+            p.target = i;
+            p.cost = cost;
+        }
+    }
+    if (p.target >= 0) {
+        for (int w = 0; w < TechWords; w++) {
+            p.path[w] = TechPreqBits[p.target][w] & ~owned[w];
+        }
+    }
+    return targets;
+}
+
+/*
+Update the research plan for the faction. Full planning solves the minimum cost for
+every technology as a target and selects the best key tech by value per research cost.
+Return Value: Current target tech_id or -1 if there is no plan
+*/
+int tech_plan_update(int faction_id) {
+    assert(faction_id > 0 && faction_id < MaxPlayerNum);
+    TechPlan& p = tech_plans[faction_id];
+    uint32_t owned[TechWords];
+    tech_plan_owned(faction_id, owned);
+    if (p.target >= 0 && p.turn >= 0 && *CurrentTurn - p.turn < TechPlanTurns
+    && !(owned[p.target / 32] & (1u << (p.target % 32)))) {
+        for (int w = 0; w < TechWords; w++) {
+            uint32_t gained = owned[w] & ~p.owned[w] & p.path[w];
+            while (gained) {
+                int tech_id = 32*w + __builtin_ctz(gained);
+                gained &= gained - 1;
+                p.cost -= p.costs[tech_id];
+            }
+            p.path[w] &= ~owned[w];
+            p.owned[w] = owned[w];
+        }
+        return p.target;
+    }
+    int best_score;
+    tech_plan_full(faction_id, owned, &best_score);
+    if (p.target >= 0) {
+        debug("tech_plan %d %d cost: %d score: %d target: %s\n",
+            *CurrentTurn, faction_id, p.cost, best_score, Tech[p.target].name);
+    }
+    return p.target;
+}
+
+#ifdef BUILD_DEBUG
+/*
+Timing check for the research planner. Full planning is repeated for every active
+faction and the average time for one pass over all factions is written to the log.
+The current plans are restored afterwards.
+*/
+void tech_plan_check() {
+    const int Rounds = 100;
+    std::vector<TechPlan> saved(tech_plans, tech_plans + MaxPlayerNum);
+    uint32_t owned[MaxPlayerNum][TechWords] = {};
+    int factions = 0;
+    int targets = 0;
+    int best_score;
+    LARGE_INTEGER freq, start, end;
+    for (int i = 1; i < MaxPlayerNum; i++) {
+        if (is_alive(i)) {
+            tech_plan_owned(i, owned[i]);
+            factions++;
+        }
+    }
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&start);
+    for (int j = 0; j < Rounds; j++) {
+        targets = 0;
+        for (int i = 1; i < MaxPlayerNum; i++) {
+            if (is_alive(i)) {
+                targets += tech_plan_full(i, owned[i], &best_score);
+            }
+        }
+    }
+    QueryPerformanceCounter(&end);
+    std::copy(saved.begin(), saved.end(), tech_plans);
+    debug("tech_plan_check factions: %d targets: %d rounds: %d pass_us: %.1f\n",
+        factions, targets, Rounds, 1e6 * (end.QuadPart - start.QuadPart) / freq.QuadPart / Rounds);
+    flushlog();
+}
+#endif
+
+/*
+Check if the specified tech is part of the research path for the current plan.
+*/
+bool tech_plan_path(int tech_id, int faction_id) {
+    TechPlan& p = tech_plans[faction_id];
+    return p.target >= 0 && tech_id >= 0 && tech_id < MaxTechnologyNum
+        && (p.path[tech_id / 32] & (1u << (tech_id % 32)));
+}
+
 /*
 Replace tech_val for some parts of the diplomacy dialog related to tech trading.
 */
@@ -4,6 +4,7 @@
 
 const char* tech_str(int tech_id);
 int __cdecl has_tech(int tech_id, int faction_id);
+void tech_preq_init();
 int __cdecl tech_level(int tech_id, int lvl);
 int __cdecl tech_category(int tech_id);
 int __cdecl mod_tech_avail(int tech_id, int faction_id);
@@ -17,5 +18,11 @@ int __cdecl tech_is_preq(int preq_tech_id, int parent_tech_id, int range);
 int __cdecl mod_tech_val(int tech_id, int faction_id, int flag);
 int __cdecl mod_tech_ai(int faction_id);
 int tech_cost(int tech_id, int faction_id);
+void tech_plan_reset();
+int tech_plan_update(int faction_id);
+bool tech_plan_path(int tech_id, int faction_id);
+#ifdef BUILD_DEBUG
+void tech_plan_check();
+#endif
 int __cdecl tech_alt_val(int tech_id, int faction_id, int flag);
 
@@ -409,7 +409,7 @@ int __cdecl proto_speed(int unit_id) {
         }
     }
     speed_val = clamp(speed_val, 1, 99) * Rules->move_rate_roads;
-    assert(speed_val == speed_proto(unit_id));
+    shadow_check(SC_SpeedProto, speed_val, speed_proto(unit_id), "unit: %d", unit_id);
     return speed_val;
 }
 
@@ -1673,7 +1673,8 @@ VehArmor armor_id, VehAblFlag ability, VehReactor reactor_id) {
     int cost = (proto_mod * (abil_modifier + 4) + 2) / 4;
 //    debug("proto_cost %d %d %d %d %d cost: %d\n",
 //        chassis_id, weapon_id, armor_id, ability, reactor_id, cost);
-    assert(cost == proto_cost(chassis_id, weapon_id, armor_id, ability, reactor_id));
+    shadow_check(SC_ProtoCost, cost, proto_cost(chassis_id, weapon_id, armor_id, ability, reactor_id),
+        "%d %d %d %d %d", chassis_id, weapon_id, armor_id, ability, reactor_id);
     return cost;
 }
 
@@ -1713,7 +1714,8 @@ int __cdecl mod_veh_cost(int unit_id, int base_id, int32_t* has_proto_cost) {
     if (has_proto_cost) {
         *has_proto_cost = proto_cost_first != 0;
     }
-    assert(cost == veh_cost(unit_id, base_id, 0));
+    shadow_check(SC_VehCost, cost, veh_cost(unit_id, base_id, 0),
+        "unit: %d base: %d", unit_id, base_id);
     return cost;
 }
 
@@ -1750,7 +1752,8 @@ int __cdecl mod_upgrade_cost(int faction_id, int new_unit_id, int old_unit_id) {
         if (has_project(FAC_NANO_FACTORY, faction_id)) {
             cost /= 2;
         }
-        assert(cost == upgrade_cost(faction_id, new_unit_id, old_unit_id));
+        shadow_check(SC_UpgradeCost, cost, upgrade_cost(faction_id, new_unit_id, old_unit_id),
+            "faction: %d unit: %d %d", faction_id, new_unit_id, old_unit_id);
     }
     return cost;
 }
@@ -2117,7 +2120,8 @@ int __cdecl mod_stack_check(int veh_id, int type, int cond1, int cond2, int cond
             break;
         }
     }
-    assert(value == stack_check(veh_id, type, cond1, cond2, cond3));
+    shadow_check(SC_StackCheck, value, stack_check(veh_id, type, cond1, cond2, cond3),
+        "veh: %d type: %d %d %d %d", veh_id, type, cond1, cond2, cond3);
     return value;
 }
 
@@ -290,7 +290,8 @@ int __cdecl mod_offense_proto(int unit_id, int veh_id_def, int is_bombard) {
         value = (veh_id_def < 0) ? Rules->psi_combat_ratio_atk[TRIAD_LAND] : // PSI
            Rules->psi_combat_ratio_atk[Vehs[veh_id_def].triad()] * 8;
     }
-    assert(value == offense_proto(unit_id, veh_id_def, is_bombard));
+    shadow_check(SC_OffenseProto, value, offense_proto(unit_id, veh_id_def, is_bombard),
+        "unit: %d veh_def: %d bombard: %d", unit_id, veh_id_def, is_bombard);
     return value;
 }
 
@@ -315,7 +316,8 @@ int __cdecl mod_armor_proto(int unit_id, int veh_id_atk, int is_bombard) {
         value = (veh_id_atk < 0) ? Rules->psi_combat_ratio_def[TRIAD_LAND] : // PSI
             Rules->psi_combat_ratio_def[unit->triad()] * 8;
     }
-    assert(value == armor_proto(unit_id, veh_id_atk, is_bombard));
+    shadow_check(SC_ArmorProto, value, armor_proto(unit_id, veh_id_atk, is_bombard),
+        "unit: %d veh_atk: %d bombard: %d", unit_id, veh_id_atk, is_bombard);
     return value;
 }
 
@@ -494,7 +496,11 @@ static int __cdecl find_defender(int veh_id_def, int veh_id_atk, int check_arty)
         }
         int offense_out = 0;
         int defense_out = 0;
-        mod_battle_compute(veh_id_atk, veh_id, &offense_out, &defense_out, flags);
+        if (veh_id_atk >= 0) {
+            battle_compute_cached(veh_id_atk, veh_id, &offense_out, &defense_out, flags);
+        } else {
+            mod_battle_compute(veh_id_atk, veh_id, &offense_out, &defense_out, flags);
+        }
         if (!offense_out) {
             break;
         }
@@ -624,10 +630,16 @@ bool use_nerve_gas(int faction_id_atk) {
     return false;
 }
 
+/*
+Battle modifier display strings are only needed when the combat is shown to the player.
+AI evaluations through battle_compute_cached disable them to avoid the string copies.
+*/
+static bool battle_display = true;
+
 void __cdecl add_bat(int type, int modifier, const char* display_str)
 {
     int offset = VehBattleModCount[type];
-    if (modifier && offset >= 0 && offset < 4 && (type == 0 || type == 1)) {
+    if (battle_display && modifier && offset >= 0 && offset < 4 && (type == 0 || type == 1)) {
         strcpy_n(VehBattleDisplay[type][offset], 80, display_str);
         VehBattleModifier[type][offset] = modifier;
         VehBattleModCount[type]++;
@@ -1072,6 +1084,194 @@ void __cdecl mod_battle_compute(int veh_id_atk, int veh_id_def, int* offense_out
     }
 }
 
+/*
+Cache for combat strength evaluations used by AI decision making. Entries are keyed by
+all unit properties read by mod_battle_compute (unit type, owner, morale, home base
+and location for both units, including tile improvements) and are invalidated by incrementing
+combat_cache_epoch on turn and base upkeep, tech changes and move_upkeep_event base or terrain
+events (bases founded, captured or destroyed and altitude changes).
+
+Only the items of the two combat tiles are part of the key. Sensors and bases on nearby
+tiles also change the strengths, so items changed by the engine terraforming code (which
+does not report move_upkeep_event) may return stale values until the next epoch.
+*/
+const int CombatCacheSize = 4096;
+
+struct CombatCacheEntry {
+    uint32_t epoch;
+    int16_t atk_x;
+    int16_t atk_y;
+    int16_t def_x;
+    int16_t def_y;
+    int16_t atk_unit_id;
+    int16_t def_unit_id;
+    int16_t atk_home_id;
+    int16_t def_home_id;
+    uint8_t atk_faction_id;
+    uint8_t def_faction_id;
+    uint8_t atk_morale;
+    uint8_t def_morale;
+    uint32_t atk_state;
+    uint32_t atk_items;
+    uint32_t def_items;
+    int32_t combat_type;
+    int32_t offense;
+    int32_t defense;
+};
+
+static CombatCacheEntry combat_cache[CombatCacheSize];
+static uint32_t combat_cache_epoch = 1;
+
+void combat_cache_reset() {
+    combat_cache_epoch++;
+}
+
+/*
+Calculate the same offense and defense values as mod_battle_compute without the battle display.
+*/
+void battle_compute_cached(int veh_id_atk, int veh_id_def, int* offense_out, int* defense_out, int combat_type)
+{
+    assert(veh_id_atk >= 0 && veh_id_atk < *VehCount);
+    assert(veh_id_def >= 0 && veh_id_def < *VehCount);
+    VEH* veh_atk = &Vehs[veh_id_atk];
+    VEH* veh_def = &Vehs[veh_id_def];
+    MAP* sq_atk = mapsq(veh_atk->x, veh_atk->y);
+    MAP* sq_def = mapsq(veh_def->x, veh_def->y);
+    CombatCacheEntry key = {};
+    key.epoch = combat_cache_epoch;
+    key.atk_x = veh_atk->x;
+    key.atk_y = veh_atk->y;
+    key.def_x = veh_def->x;
+    key.def_y = veh_def->y;
+    key.atk_unit_id = veh_atk->unit_id;
+    key.def_unit_id = veh_def->unit_id;
+    key.atk_home_id = veh_atk->home_base_id;
+    key.def_home_id = veh_def->home_base_id;
+    key.atk_faction_id = veh_atk->faction_id;
+    key.def_faction_id = veh_def->faction_id;
+    key.atk_morale = veh_atk->morale;
+    key.def_morale = veh_def->morale;
+    key.atk_state = veh_atk->state & VSTATE_MADE_AIRDROP;
+    key.atk_items = (sq_atk ? sq_atk->items : 0);
+    key.def_items = (sq_def ? sq_def->items : 0);
+    key.combat_type = combat_type;
+
+    uint32_t hash = pair_hash(pair_hash(veh_atk->x | (veh_atk->y << 16), veh_def->x | (veh_def->y << 16)),
+        pair_hash(veh_atk->unit_id | (veh_def->unit_id << 16), combat_type));
+    CombatCacheEntry& entry = combat_cache[hash % CombatCacheSize];
+    if (!memcmp(&entry, &key, offsetof(CombatCacheEntry, offense))) {
+        *offense_out = entry.offense;
+        *defense_out = entry.defense;
+        return;
+    }
+    battle_display = false;
+    mod_battle_compute(veh_id_atk, veh_id_def, &key.offense, &key.defense, combat_type);
+    battle_display = true;
+    entry = key;
+    *offense_out = key.offense;
+    *defense_out = key.defense;
+}
+
+const int BattleMaxRounds = 40;
+
+/*
+Probability that the attacker wins a single round in mod_battle_fight_2.
+Both sides roll combat_rand on their strength and the attacker wins only
+when its roll is strictly higher than the defender roll.
+*/
+double battle_round_odds(int offense, int defense) {
+    double A = max(1, offense);
+    double D = max(1, defense);
+    if (A <= D) {
+        return (A - 1) / (2 * D);
+    }
+    return 1.0 - (D + 1) / (2 * A);
+}
+
+/*
+Exact probability that the attacker destroys the defender before losing all its rounds.
+The table is filled by dynamic programming over the remaining rounds for both sides,
+rounds are equal to hitpoints divided by the damage dealt per round.
+Special abilities that end the combat early (marine detachment, retreat) are not included.
+*/
+double battle_odds(int offense, int defense, int atk_rounds, int def_rounds) {
+    static double odds[BattleMaxRounds + 1];
+    if (atk_rounds <= 0 || def_rounds <= 0) {
+        return (def_rounds <= 0 && atk_rounds > 0 ? 1.0 : 0.0);
+    }
+    assert(atk_rounds <= BattleMaxRounds && def_rounds <= BattleMaxRounds);
+    atk_rounds = min(atk_rounds, BattleMaxRounds);
+    def_rounds = min(def_rounds, BattleMaxRounds);
+    const double p = battle_round_odds(offense, defense);
+    const double q = 1.0 - p;
+    // odds[j] holds the win probability for i attacker rounds and j defender rounds left
+    for (int j = 1; j <= def_rounds; j++) {
+        odds[j] = 0.0;
+    }
+    for (int i = 1; i <= atk_rounds; i++) {
+        double prev = 1.0;
+        for (int j = 1; j <= def_rounds; j++) {
+            prev = p * prev + q * odds[j];
+            odds[j] = prev;
+        }
+    }
+    return odds[def_rounds];
+}
+
+/*
+Simulate the combat rounds with a local generator so that the game random state is unchanged.
+Only used in debug builds to verify the exact odds calculation.
+*/
+static double battle_odds_sample(int offense, int defense, int atk_rounds, int def_rounds, int trials) {
+    static uint32_t seed = 0x5f3759df;
+    int wins = 0;
+    for (int i = 0; i < trials; i++) {
+        int atk_left = atk_rounds;
+        int def_left = def_rounds;
+        while (atk_left > 0 && def_left > 0) {
+            seed = 1664525 * seed + 1013904223;
+            int off_rand = (offense > 1 ? (seed >> 8) % offense : 0);
+            seed = 1664525 * seed + 1013904223;
+            int def_rand = (defense > 1 ? (seed >> 8) % defense : 0);
+            if (off_rand <= def_rand) {
+                atk_left--;
+            } else {
+                def_left--;
+            }
+        }
+        wins += (def_left <= 0);
+    }
+    return (1.0 * wins) / trials;
+}
+
+/*
+Attacker win probability using combat strengths from mod_battle_compute.
+Damage per round follows the same reactor rules as mod_battle_fight_2.
+*/
+double battle_odds_veh(int veh_id_atk, int veh_id_def, int offense, int defense) {
+    VEH* veh_atk = &Vehs[veh_id_atk];
+    VEH* veh_def = &Vehs[veh_id_def];
+    bool psi_combat = (veh_atk->offense_value() < 0 || veh_def->defense_value() < 0);
+    int atk_val = 1;
+    int def_val = 1;
+    if (conf.ignore_reactor_power || psi_combat) {
+        atk_val = veh_atk->reactor_type();
+        def_val = veh_def->reactor_type();
+    }
+    int atk_rounds = (veh_atk->cur_hitpoints() + atk_val - 1) / atk_val;
+    int def_rounds = (veh_def->cur_hitpoints() + def_val - 1) / def_val;
+    double value = battle_odds(offense, defense, atk_rounds, def_rounds);
+    if (DEBUG && shadow_sample(SC_BattleOdds)) {
+        double sample = battle_odds_sample(offense, defense, atk_rounds, def_rounds, 4000);
+        debug_ver("battle_odds %d %d rounds: %d %d odds: %.4f sample: %.4f\n",
+            offense, defense, atk_rounds, def_rounds, value, sample);
+        shadow_verify(SC_BattleOdds, fabs(value - sample) < 0.04,
+            "%d %d rounds: %d %d odds: %.4f sample: %.4f",
+            offense, defense, atk_rounds, def_rounds, value, sample);
+    }
+    return value;
+}
+
 /*
 Check for possible promotions after victorious combat event unless capturing artifacts.
 */
@@ -1332,10 +1532,11 @@ int __cdecl mod_battle_fight_2(int veh_id_atk, int offset, int tx, int ty, int t
             *def_id = veh_id_def;
         }
         int value = offense * ((combat_type & CT_CAN_ARTY) ? 4 : 8) / (defense + 1);
-        if (DEBUG) {
+        if (DEBUG && shadow_sample(SC_BattleFight)) {
             int res_id = -1;
-            assert(value == battle_fight_2(veh_id_atk, offset, tx, ty, table_offset, option, &res_id));
-            assert(veh_id_def == res_id);
+            int expected = battle_fight_2(veh_id_atk, offset, tx, ty, table_offset, option, &res_id);
+            shadow_verify(SC_BattleFight, value == expected && veh_id_def == res_id,
+                "value: %d expected: %d veh_def: %d %d", value, expected, veh_id_def, res_id);
         }
         return value;
     }
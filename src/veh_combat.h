@@ -27,6 +27,11 @@ bool use_nerve_gas(int faction_id_atk, int faction_id_def);
 bool use_nerve_gas(int faction_id_atk);
 void __cdecl add_bat(int type, int modifier, const char* display_str);
 void __cdecl mod_battle_compute(int veh_id_atk, int veh_id_def, int* offense_out, int* defense_out, int combat_type);
+void combat_cache_reset();
+void battle_compute_cached(int veh_id_atk, int veh_id_def, int* offense_out, int* defense_out, int combat_type);
+double battle_round_odds(int offense, int defense);
+double battle_odds(int offense, int defense, int atk_rounds, int def_rounds);
+double battle_odds_veh(int veh_id_atk, int veh_id_def, int offense, int defense);
 void __cdecl promote(int veh_id);
 int __cdecl interceptor(int faction_id_def, int faction_id_atk, int tx, int ty);
 int __cdecl mod_battle_fight(int veh_id, int offset, int table_offset, int option, int* def_id);
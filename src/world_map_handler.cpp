@@ -454,6 +454,13 @@ static void sr_announce_tile(int x, int y) {
     n = sr_tile_workstatus(part, sizeof(part), x, y, sq);
     if (n > 0) pos += snprintf(buf + pos, sizeof(buf) - pos, ". %s", part);
 
+    // Fuel range of the selected aircraft, including the way back for refuelling
+    int veh_id = (MapWin ? MapWin->iUnit : -1);
+    if (veh_id >= 0 && veh_id < *VehCount && Vehs[veh_id].faction_id == faction
+    && !air_reachable(veh_id, x, y)) {
+        pos += snprintf(buf + pos, sizeof(buf) - pos, ". %s", loc(SR_TILE_OUT_OF_RANGE));
+    }
+
     sr_debug_log("TILE-ANNOUNCE (%d,%d): %s", x, y, buf);
     sr_output(buf, false);
 }
@@ -2409,11 +2416,14 @@ bool HandleKey(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
                     int odds_off = odds_off_val >> 8;
                     int odds_def = odds_def_val >> 8;
                     if (odds_off > 0 || odds_def > 0) {
+                        int win = (int)(100 * battle_odds_veh(MapWin->iUnit, vid, odds_off_val, odds_def_val) + 0.5);
                         pos += snprintf(buf + pos, sizeof(buf) - pos, ", ");
                         pos += snprintf(buf + pos, sizeof(buf) - pos, loc(SR_COMBAT_ODDS), odds_off, odds_def);
-                        if (odds_off > odds_def * 3 / 2) {
+                        pos += snprintf(buf + pos, sizeof(buf) - pos, ", ");
+                        pos += snprintf(buf + pos, sizeof(buf) - pos, loc(SR_COMBAT_WIN_CHANCE), win);
+                        if (win >= 60) {
                             pos += snprintf(buf + pos, sizeof(buf) - pos, " %s", loc(SR_COMBAT_ODDS_FAVORABLE));
-                        } else if (odds_def > odds_off * 3 / 2) {
+                        } else if (win <= 40) {
                             pos += snprintf(buf + pos, sizeof(buf) - pos, " %s", loc(SR_COMBAT_ODDS_UNFAVORABLE));
                         } else {
                             pos += snprintf(buf + pos, sizeof(buf) - pos, " %s", loc(SR_COMBAT_ODDS_EVEN));
@@ -2510,6 +2520,15 @@ bool HandleKey(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
                                         e_morale, ev->cur_hitpoints(), ev->max_hitpoints(),
                                         cp_off, cp_def);
                                 }
+                                int cp_win = (int)(100 * battle_odds_veh(MapWin->iUnit, evid, cp_off_val, cp_def_val) + 0.5);
+                                int cp_len = strlen(cbuf);
+                                if (cp_len > 0 && cbuf[cp_len - 1] == '.') {
+                                    cp_len--;
+                                }
+                                cp_len += snprintf(cbuf + cp_len, sizeof(cbuf) - cp_len, ", ");
+                                cp_len += snprintf(cbuf + cp_len, sizeof(cbuf) - cp_len,
+                                    loc(SR_COMBAT_WIN_CHANCE), cp_win);
+                                snprintf(cbuf + cp_len, sizeof(cbuf) - cp_len, ".");
                                 sr_output(cbuf, true);
                             }
                         }